@@ -19,7 +19,7 @@ layout(set=0, binding=0, std430, row_major) readonly buffer SceneSet
 
 layout(set=2, binding=0, std430, row_major) readonly buffer ModelSet 
 { 
-  Transform modelworld;
+  Transform modelworlds[];
 
 } model;
 
@@ -28,7 +28,7 @@ layout(location=4) out vec2 texcoord;
 ///////////////////////// main //////////////////////////////////////////////
 void main()
 {
-  Transform modelworld = model.modelworld;
+  Transform modelworld = model.modelworlds[gl_InstanceIndex];
   
   texcoord = vertex_texcoord;
   
@@ -307,7 +307,7 @@ namespace
     int i0, i1;
     float dt;
 
-    atomic<int> *latch;
+    Arena scratch;
   };
 
   void update_thread(DatumPlatform::PlatformInterface &platform, void *ldata, void *rdata)
@@ -333,7 +333,7 @@ namespace
 
     GeometryList::BuildState buildstate;
 
-    if (cmdlist.begin(buildstate, state.rendercontext, state.resources))
+    if (cmdlist.begin(buildstate, state.rendercontext, state.resources, work.scratch))
     {
       auto camerapos = state.camera.position();
 
@@ -356,8 +356,6 @@ namespace
 
       cmdlist.finalise(buildstate);
     }
-
-    *work.latch -= 1;
   }
 }
 
@@ -497,7 +495,7 @@ void example_update(DatumPlatform::PlatformInterface &platform, DatumPlatform::G
 
     state.camera = normalise(state.camera);
 
-    atomic<int> latch(ThreadCount);
+    DatumPlatform::WorkCounter counter;
 
     WorkOrder work[ThreadCount];
     for(int i = 0; i < ThreadCount; ++i)
@@ -506,16 +504,15 @@ void example_update(DatumPlatform::PlatformInterface &platform, DatumPlatform::G
       work[i].i0 = i * extentof(state.instances) / ThreadCount;
       work[i].i1 = min(work[i].i0 + extentof(state.instances) / ThreadCount, extentof(state.instances));
       work[i].dt = dt;
-      work[i].latch = &latch;
+      work[i].scratch = allocate(platform.gamescratchmemory, 2*1024*1024);
     }
 
     for(int i = 1; i < ThreadCount; ++i)
-      platform.submit_work(update_thread, &state, &work[i]);
+      platform.submit_work(update_thread, &state, &work[i], &counter, nullptr);
 
     update_thread(platform, &state, &work[0]);
 
-    while (latch != 0)
-      ;
+    platform.wait_work(&counter);
   }
 }
 
@@ -180,7 +180,7 @@ void example_render(DatumPlatform::PlatformInterface &platform, DatumPlatform::V
       GeometryList geometry;
       GeometryList::BuildState buildstate;
 
-      if (geometry.begin(buildstate, state.rendercontext, state.resources))
+      if (geometry.begin(buildstate, state.rendercontext, state.resources, platform.renderscratchmemory, state.camera))
       {
         geometry.push_mesh(buildstate, Transform::translation(0.0f, -3.0f, -8.0f)*Transform::rotation(Vec3(0, 1, 0), pi<float>()/4), state.animator.pose, state.mesh, state.material);
 
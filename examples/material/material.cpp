@@ -176,7 +176,7 @@ void example_render(DatumPlatform::PlatformInterface &platform, DatumPlatform::V
       GeometryList geometry;
       GeometryList::BuildState buildstate;
 
-      if (geometry.begin(buildstate, state.rendercontext, state.resources))
+      if (geometry.begin(buildstate, state.rendercontext, state.resources, platform.renderscratchmemory, state.camera))
       {
         geometry.push_mesh(buildstate, Transform::translation(0.0f, -25.0f, -85.0f) * Transform::rotation(Vec3(0, -1, 0), state.time), state.mesh, state.material);
 
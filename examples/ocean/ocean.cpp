@@ -184,7 +184,7 @@ void example_render(DatumPlatform::PlatformInterface &platform, DatumPlatform::V
       GeometryList geometry;
       GeometryList::BuildState buildstate;
 
-      if (geometry.begin(buildstate, state.rendercontext, state.resources))
+      if (geometry.begin(buildstate, state.rendercontext, state.resources, platform.renderscratchmemory, state.camera))
       {
         Vec3 bumpscale = Vec3(0.2f, 0.2f, 0.2f);
         float foamwaveheight = 0.55f;
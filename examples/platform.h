@@ -12,11 +12,10 @@
 #include <vector>
 #include <thread>
 #include <deque>
+#include <memory>
 #include <mutex>
 #include <atomic>
 #include <condition_variable>
-#include <functional>
-#include <fstream>
 
 namespace DatumPlatform
 {
@@ -94,29 +93,96 @@ namespace DatumPlatform
   class WorkQueue
   {
     public:
-      WorkQueue(int threads = 4);
+
+      static constexpr int MaxThreads = 32;
+      static constexpr int DequeSize = 1024;
+      static constexpr int PoolSize = 4096;
+
+      using work_t = void (*)(PlatformInterface &, void*, void*);
+
+    public:
+      WorkQueue(int threads = 0); // 0 = hardware concurrency
       ~WorkQueue();
 
-      template<typename Func>
-      void push(Func &&func)
+      void push(work_t func, PlatformInterface *platform, void *ldata, void *rdata, WorkCounter *counter = nullptr, WorkCounter *dependency = nullptr);
+
+      void wait(WorkCounter *counter);
+
+      int threads() const { return int(m_threads.size()); }
+
+    private:
+
+      struct Job
+      {
+        work_t func;
+        PlatformInterface *platform;
+
+        void *ldata;
+        void *rdata;
+
+        WorkCounter *counter;
+
+        Job *waitnext;
+
+        std::atomic<uint32_t> next;
+      };
+
+      // Chase-Lev work stealing deque, owner pushes and pops the bottom,
+      // other threads steal from the top
+
+      struct Deque
       {
-        std::unique_lock<std::mutex> lock(m_mutex);
+        std::atomic<int64_t> top;
+        char pad0[64 - sizeof(std::atomic<int64_t>)];
+
+        std::atomic<int64_t> bottom;
+        char pad1[64 - sizeof(std::atomic<int64_t>)];
+
+        std::atomic<Job*> jobs[DequeSize];
+
+        bool push(Job *job);
+        Job *pop();
+        Job *steal();
+      };
+
+      int local();
+
+      Job *allocate();
+      void release(Job *job);
 
-        m_queue.push_back(std::forward<Func>(func));
+      void enqueue(Job *job);
 
-        m_signal.notify_one();
-      }
+      Job *acquire(int index);
+
+      void execute(Job *job);
+      void complete(WorkCounter *counter);
 
     private:
 
       std::atomic<bool> m_done;
 
+      std::atomic<int> m_threadcount;
+
+      std::unique_ptr<Deque[]> m_deques;
+
+      std::unique_ptr<Job[]> m_jobs;
+      std::atomic<uint64_t> m_freejobs;
+
+      std::mutex m_waitlock;
+
+      // jobs from a full deque, or from threads beyond the deque table, are
+      // parked here, never run inline
+
+      std::mutex m_spilllock;
+      Job *m_spillhead, *m_spilltail;
+      std::atomic<int> m_spillcount;
+
+      std::atomic<int> m_sleeping;
+
       std::mutex m_mutex;
 
       std::condition_variable m_signal;
 
-      std::deque<std::function<void()>> m_queue;
-
       std::vector<std::thread> m_threads;
   };
 
@@ -128,14 +194,99 @@ namespace DatumPlatform
   {
     public:
       FileHandle(const char *path);
+      ~FileHandle();
+
+      FileHandle(FileHandle const &) = delete;
+      FileHandle &operator=(FileHandle const &) = delete;
 
       size_t read(uint64_t position, void *buffer, std::size_t bytes);
 
     private:
 
-      std::mutex m_lock;
+#ifdef _WIN32
+      void *m_handle;
+#else
+      int m_fd;
+#endif
+  };
+
+
+  //|---------------------- IOQueue -------------------------------------------
+  //|--------------------------------------------------------------------------
+
+  class IOQueue
+  {
+    public:
 
-      std::fstream m_fio;
+      struct ReadRequest
+      {
+        FileHandle *file;
+
+        uint64_t position;
+        void *buffer;
+        std::size_t bytes;
+
+        std::size_t result;
+      };
+
+      static constexpr int PoolSize = 1024;
+
+      using callback_t = void (*)(PlatformInterface &, void*, std::size_t);
+
+    public:
+      IOQueue(int threads = 4);
+      ~IOQueue();
+
+      // queues the read, on completion callback(platform, userdata, bytesread)
+      // is submitted to the work queue
+
+      void read_async(WorkQueue &workqueue, PlatformInterface *platform, FileHandle *file, uint64_t position, void *buffer, std::size_t bytes, callback_t callback, void *userdata);
+
+      int threads() const { return int(m_threads.size()); }
+
+    private:
+
+      struct AsyncRead
+      {
+        ReadRequest request;
+
+        WorkQueue *workqueue;
+        PlatformInterface *platform;
+
+        callback_t callback;
+        void *userdata;
+
+        bool overflow;
+
+        AsyncRead *next;
+      };
+
+      struct Read
+      {
+        ReadRequest *request;
+
+        AsyncRead *async;
+      };
+
+      void execute(Read const &read);
+
+      static void complete(PlatformInterface &platform, void *ldata, void *rdata);
+
+    private:
+
+      std::atomic<bool> m_done;
+
+      std::unique_ptr<AsyncRead[]> m_reads;
+
+      AsyncRead *m_freereads;
+
+      std::mutex m_mutex;
+
+      std::condition_variable m_signal;
+
+      std::deque<Read> m_queue;
+
+      std::vector<std::thread> m_threads;
   };
 
 } // namespace
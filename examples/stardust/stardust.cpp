@@ -130,8 +130,6 @@ namespace
     int i;
     int k0;
     int i0, i1;
-
-    atomic<int> *latch;
   };
 
   void update_thread(DatumPlatform::PlatformInterface &platform, void *ldata, void *rdata)
@@ -169,8 +167,6 @@ namespace
 
       cmdlist.finalise(buildstate);
     }
-
-    *work.latch -= 1;
   }
 }
 
@@ -335,7 +331,7 @@ void example_update(DatumPlatform::PlatformInterface &platform, DatumPlatform::G
       state.palettefactor = 0.0f;
     }
 
-    atomic<int> latch(ThreadCount);
+    DatumPlatform::WorkCounter counter;
 
     WorkOrder work[ThreadCount];
     for(int i = 0; i < ThreadCount; ++i)
@@ -344,16 +340,14 @@ void example_update(DatumPlatform::PlatformInterface &platform, DatumPlatform::G
       work[i].k0 = i * 1000;
       work[i].i0 = i * extentof(state.particles) / ThreadCount;
       work[i].i1 = min(work[i].i0 + extentof(state.particles) / ThreadCount, extentof(state.particles));
-      work[i].latch = &latch;
     }
 
     for(int i = 1; i < ThreadCount; ++i)
-      platform.submit_work(update_thread, &state, &work[i]);
+      platform.submit_work(update_thread, &state, &work[i], &counter, nullptr);
 
     update_thread(platform, &state, &work[0]);
 
-    while (latch != 0)
-      ;
+    platform.wait_work(&counter);
   }
 }
 
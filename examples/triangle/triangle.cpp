@@ -156,7 +156,7 @@ void example_render(DatumPlatform::PlatformInterface &platform, DatumPlatform::V
       GeometryList geometry;
       GeometryList::BuildState buildstate;
 
-      if (geometry.begin(buildstate, state.rendercontext, state.resources))
+      if (geometry.begin(buildstate, state.rendercontext, state.resources, platform.renderscratchmemory, state.camera))
       {
         geometry.push_mesh(buildstate, Transform::identity(), state.mesh, state.material);
 
@@ -26,6 +26,8 @@ AssetManager::AssetManager(allocator_type const &allocator)
 {
   m_head = nullptr;
 
+  m_freeloads = nullptr;
+
 #ifdef DEBUG
   barriercount = 0;
 #endif
@@ -46,6 +48,18 @@ void AssetManager::initialise(size_t slotcount, size_t slabsize)
   m_head->next = m_head;
   m_head->state = Slot::State::Empty;
 
+  auto loads = allocate<Load>(m_allocator, MaxLoads);
+  auto blocks = allocate<PackBlock>(m_allocator, MaxLoads);
+
+  for(size_t i = 0; i < MaxLoads; ++i)
+  {
+    loads[i].manager = this;
+    loads[i].block = blocks + i;
+    loads[i].next = m_freeloads;
+
+    m_freeloads = loads + i;
+  }
+
   cout << "Asset Storage: " << slotcount / 1024 << "k, " << slabsize / 1024 / 1024 << " MiB" << endl;
 }
 
@@ -405,15 +419,26 @@ void const *AssetManager::request(DatumPlatform::PlatformInterface &platform, As
 
   if (!slot)
   {
-    slot = acquire_slot(assetex.datasize);
+    // in flight loads are bounded, a request that finds none free retries later
 
-    if (slot)
+    if (m_freeloads)
     {
-      slot->state = Slot::State::Loading;
+      slot = acquire_slot(assetex.datasize);
+
+      if (slot)
+      {
+        slot->state = Slot::State::Loading;
+
+        slot->asset = &assetex;
+
+        auto load = m_freeloads;
 
-      slot->asset = &assetex;
+        m_freeloads = load->next;
 
-      platform.submit_work(background_loader, this, slot);
+        load->slot = slot;
+
+        platform.submit_work(background_loader, this, load);
+      }
     }
   }
   else
@@ -466,74 +491,152 @@ void AssetManager::release_barrier(uintptr_t barrier)
 ///////////////////////// AssetManager::background_loader ///////////////////
 void AssetManager::background_loader(DatumPlatform::PlatformInterface &platform, void *ldata, void *rdata)
 {
-  BEGIN_TIMED_BLOCK(Asset, lml::Color3(0.2f, 1.0f, 0.4f))
+  auto &load = *static_cast<Load*>(rdata);
 
-  auto &manager = *static_cast<AssetManager*>(ldata);
+  auto asset = load.slot->asset;
 
-  auto &slot = *static_cast<Slot*>(rdata);
+  if (asset->file == nullptr)
+  {
+    load_failed(load, "Invalid File Handle");
 
-  auto asset = slot.asset;
+    return;
+  }
 
-  try
-  {
-    if (asset->file == nullptr)
-      throw runtime_error("Invalid File Handle");
+  load.filepos = asset->datapos;
 
-    uint64_t filepos = asset->datapos;
+  platform.read_handle_async(asset->file->handle, load.filepos, &load.chunk, sizeof(load.chunk), chunk_loaded, &load);
+}
 
-    PackChunk chunk;
 
-    filepos += platform.read_handle(asset->file->handle, asset->datapos, &chunk, sizeof(PackChunk));
+///////////////////////// AssetManager::chunk_loaded ////////////////////////
+void AssetManager::chunk_loaded(DatumPlatform::PlatformInterface &platform, void *userdata, size_t bytes)
+{
+  auto &load = *static_cast<Load*>(userdata);
 
-    switch (chunk.type)
-    {
-      case "DATA"_packchunktype:
-        {
-          if (chunk.length != asset->datasize)
-            throw runtime_error("Chunk Data Size Mismatch");
+  auto asset = load.slot->asset;
 
-          filepos += platform.read_handle(asset->file->handle, filepos, slot.data, asset->datasize);
+  if (bytes != sizeof(load.chunk))
+  {
+    load_failed(load, "Asset Chunk Read Error");
+
+    return;
+  }
+
+  load.filepos += sizeof(PackChunk);
+
+  switch (load.chunk.type)
+  {
+    case "DATA"_packchunktype:
+      {
+        if (load.chunk.length != asset->datasize)
+        {
+          load_failed(load, "Chunk Data Size Mismatch");
 
           break;
         }
 
-      case "CDAT"_packchunktype:
-        {
-          size_t count = 0;
-          size_t remaining = chunk.length;
+        platform.read_handle_async(asset->file->handle, load.filepos, load.slot->data, asset->datasize, data_loaded, &load);
 
-          while (remaining != 0)
-          {
-            PackBlock block;
+        break;
+      }
 
-            auto bytes = min(sizeof(block), remaining);
+    case "CDAT"_packchunktype:
+      {
+        load.count = 0;
+        load.remaining = load.chunk.length;
 
-            filepos += platform.read_handle(asset->file->handle, filepos, &block, bytes);
+        platform.read_handle_async(asset->file->handle, load.filepos, load.block, min(sizeof(PackBlock), load.remaining), block_loaded, &load);
 
-            count += lz4_decompress(block.data, (uint8_t*)slot.data + count, block.size, asset->datasize - count);
+        break;
+      }
 
-            remaining -= bytes;
-          }
+    default:
+      load_failed(load, "Unhandled Pack Data Chunk");
+      break;
+  }
+}
 
-          break;
-        }
 
-      default:
-        throw runtime_error("Unhandled Pack Data Chunk");
-    }
+///////////////////////// AssetManager::data_loaded /////////////////////////
+void AssetManager::data_loaded(DatumPlatform::PlatformInterface &platform, void *userdata, size_t bytes)
+{
+  auto &load = *static_cast<Load*>(userdata);
 
-    {
-      leap::threadlib::SyncLock lock(manager.m_mutex);
+  if (bytes != load.slot->asset->datasize)
+  {
+    load_failed(load, "Asset Data Read Error");
 
-      slot.state = Slot::State::Loaded;
-    }
+    return;
+  }
+
+  load_complete(load);
+}
+
+
+///////////////////////// AssetManager::block_loaded ////////////////////////
+void AssetManager::block_loaded(DatumPlatform::PlatformInterface &platform, void *userdata, size_t bytes)
+{
+  BEGIN_TIMED_BLOCK(Asset, lml::Color3(0.2f, 1.0f, 0.4f));
+
+  auto &load = *static_cast<Load*>(userdata);
+
+  auto asset = load.slot->asset;
+
+  try
+  {
+    if (bytes != min(sizeof(PackBlock), load.remaining))
+      throw runtime_error("Asset Block Read Error");
+
+    load.count += lz4_decompress(load.block->data, load.slot->data + load.count, load.block->size, asset->datasize - load.count);
+
+    load.filepos += bytes;
+    load.remaining -= bytes;
+
+    // the next block completes on the work queue, never on this stack
+
+    if (load.remaining != 0)
+      platform.read_handle_async(asset->file->handle, load.filepos, load.block, min(sizeof(PackBlock), load.remaining), block_loaded, &load);
+    else
+      load_complete(load);
   }
   catch(exception &e)
   {
-    cerr << e.what() << endl;
+    load_failed(load, e.what());
+  }
+
+  END_TIMED_BLOCK(Asset);
+}
+
+
+///////////////////////// AssetManager::load_complete ///////////////////////
+void AssetManager::load_complete(Load &load)
+{
+  auto &manager = *load.manager;
+
+  leap::threadlib::SyncLock lock(manager.m_mutex);
+
+  load.slot->state = Slot::State::Loaded;
+
+  load.next = manager.m_freeloads;
+
+  manager.m_freeloads = &load;
+}
+
+
+///////////////////////// AssetManager::load_failed /////////////////////////
+void AssetManager::load_failed(Load &load, const char *msg)
+{
+  auto &manager = *load.manager;
+
+  {
+    leap::threadlib::SyncLock lock(manager.m_mutex);
+
+    load.next = manager.m_freeloads;
+
+    manager.m_freeloads = &load;
   }
 
-  END_TIMED_BLOCK(Asset)
+  cerr << msg << endl;
 }
 
 
@@ -13,6 +13,8 @@
 #include <leap/threadcontrol.h>
 #include <vector>
 
+struct PackBlock;
+
 //|---------------------- Asset ---------------------------------------------
 //|--------------------------------------------------------------------------
 
@@ -186,8 +188,42 @@ class AssetManager
 
     Slot *touch_slot(Slot *slot);
 
+    struct Load
+    {
+      AssetManager *manager;
+
+      Slot *slot;
+
+      struct
+      {
+        uint32_t length;
+        uint32_t type;
+
+      } chunk;
+
+      uint64_t filepos;
+
+      size_t count;
+      size_t remaining;
+
+      PackBlock *block;
+
+      Load *next;
+    };
+
+    static constexpr size_t MaxLoads = 16;
+
+    Load *m_freeloads;
+
     static void background_loader(DatumPlatform::PlatformInterface &platform, void *ldata, void *rdata);
 
+    static void chunk_loaded(DatumPlatform::PlatformInterface &platform, void *userdata, size_t bytes);
+    static void data_loaded(DatumPlatform::PlatformInterface &platform, void *userdata, size_t bytes);
+    static void block_loaded(DatumPlatform::PlatformInterface &platform, void *userdata, size_t bytes);
+
+    static void load_complete(Load &load);
+    static void load_failed(Load &load, const char *msg);
+
   private:
 
     mutable leap::threadlib::SpinLock m_mutex;
@@ -22,14 +22,60 @@ using namespace leap;
 using namespace leap::threadlib;
 using namespace DatumPlatform;
 
-#ifdef DEBUG
+#if defined(DEBUG) || defined(PROFILING)
 
-DebugLogEntry g_debuglog[4096];
-std::atomic<size_t> g_debuglogtail;
+DebugLogBuffer g_debuglogbuffers[32];
+std::atomic<size_t> g_debuglogthreads;
+unsigned long long g_debuglogbase = __rdtsc();
 
 DebugInfoBlock *g_infoblocks[256];
 std::atomic<size_t> g_infoblockcount;
 
+#ifdef DEBUG
+std::atomic<bool> g_profiling(true);
+#else
+std::atomic<bool> g_profiling(false);
+#endif
+
+namespace
+{
+  size_t g_debuglogcapacity = 4096;
+
+  // Profiling
+
+  const size_t ProfileFrames = 128;
+
+  struct ProfileThread
+  {
+    size_t lastentry;
+
+    size_t depth;
+
+    struct Block
+    {
+      uint32_t info;
+
+      unsigned long long beg;
+
+    } blocks[48];
+
+  } g_profilethreads[std::extent<decltype(g_debuglogbuffers)>::value];
+
+  struct ProfileBlock
+  {
+    unsigned long long frametime;
+
+    unsigned long long samples[ProfileFrames];
+
+  } g_profileblocks[std::extent<decltype(g_infoblocks)>::value];
+
+  size_t g_profileframe;
+
+  SpinLock g_profilemutex;
+}
+
+#ifdef DEBUG
+
 namespace
 {
   bool g_visible = false;
@@ -40,6 +86,8 @@ namespace
   bool g_displayblocktiming = true;
   bool g_displaygputiming = true;
   bool g_displayframegraph = false;
+  bool g_displayprofile = false;
+  bool g_displayarenas = false;
   bool g_displaydebugmenu = true;
 
   // Frame Timing
@@ -52,7 +100,7 @@ namespace
   // Block Timing
 
   const size_t Frames = 4;
-  const size_t MaxThreads = 16;
+  const size_t MaxThreads = std::extent<decltype(g_debuglogbuffers)>::value;
   const size_t MaxBlocks = 1024;
 
   unsigned long long g_blockbeg;
@@ -90,6 +138,10 @@ namespace
 
   } g_gpu;
 
+  // Merged Log
+
+  vector<DebugLogEntry> g_debuglog;
+
   // Resources
 
   struct Resources
@@ -161,6 +213,8 @@ namespace
         ToggleVisible,
         ToggleBlockTiming,
         ToggleFrameGraph,
+        ToggleProfile,
+        ToggleArenas,
         ToggleGroup,
         ToggleBoolEntry,
         SlideIntEntry,
@@ -184,15 +238,54 @@ namespace
   } g_interaction;
 
 
+  ///////////////////////// merge_debug_log ///////////////////////////////
+  void merge_debug_log()
+  {
+    g_debuglog.clear();
+
+    for(size_t i = 0, end = min(g_debuglogthreads.load(), MaxThreads); i < end; ++i)
+    {
+      auto &buffer = g_debuglogbuffers[i];
+
+      auto entries = buffer.entries.load(std::memory_order_acquire);
+
+      if (!entries)
+        continue;
+
+      size_t tail = buffer.tail.load(std::memory_order_acquire);
+
+      auto mid = g_debuglog.size();
+
+      for(size_t k = max(tail, buffer.capacity) - buffer.capacity; k < tail; ++k)
+      {
+        g_debuglog.push_back(entries[k & (buffer.capacity - 1)]);
+      }
+
+      // each thread log is already in time order
+
+      inplace_merge(g_debuglog.begin(), g_debuglog.begin() + mid, g_debuglog.end(), [](auto &lhs, auto &rhs) { return lhs.timestamp < rhs.timestamp; });
+    }
+  }
+
+
+  ///////////////////////// infoblock ///////////////////////////////////////
+  DebugInfoBlock const *infoblock(uint32_t id)
+  {
+    return (id != 0 && id <= g_infoblockcount) ? g_infoblocks[id - 1] : nullptr;
+  }
+
+
   ///////////////////////// collate_debug_log ///////////////////////////////
   void collate_debug_log()
   {
-    size_t tail = g_debuglogtail;
+    merge_debug_log();
+
+    auto &log = g_debuglog;
 
     size_t lastframes[8] = {};
-    for(size_t i = 0; i < extentof(g_debuglog); ++i)
+    for(size_t i = 0; i < log.size(); ++i)
     {
-      auto &entry = g_debuglog[(i + tail) % extentof(g_debuglog)];
+      auto &entry = log[i];
 
       if (entry.type == DebugLogEntry::FrameMarker)
       {
@@ -207,29 +300,14 @@ namespace
       }
     }
 
-    std::thread::id threads[MaxThreads] = {};
-    for(size_t i = lastframes[4]; i < lastframes[0]; ++i)
-    {
-      auto &entry = g_debuglog[(i + tail) % extentof(g_debuglog)];
-
-      for(size_t i = 0; i < extentof(threads); ++i)
-      {
-        if (threads[i] == entry.thread || threads[i] == std::thread::id())
-        {
-          threads[i] = entry.thread;
-          break;
-        }
-      }
-    }
-
-    sort(begin(threads), end(threads), std::greater<>());
-
+    if (log.empty())
+      return;
 
     //
     // Frame Timing
     //
 
-    g_frametime = g_debuglog[(lastframes[0] + tail) % extentof(g_debuglog)].timestamp - g_debuglog[(lastframes[1] + tail) % extentof(g_debuglog)].timestamp;
+    g_frametime = log[lastframes[0]].timestamp - log[lastframes[1]].timestamp;
 
     g_fpshistory[g_fpshistorytail++ % extentof(g_fpshistory)] = (float)(g_frametime / clock_frequency());
 
@@ -240,31 +318,26 @@ namespace
 
     memset(g_threads, 0, sizeof(g_threads));
 
-    g_blockbeg = g_debuglog[(lastframes[Frames+1] + tail) % extentof(g_debuglog)].timestamp;
-    g_blockend = g_debuglog[(lastframes[1] + tail) % extentof(g_debuglog)].timestamp;
+    g_blockbeg = log[lastframes[Frames+1]].timestamp;
+    g_blockend = log[lastframes[1]].timestamp;
 
     size_t opencount[MaxThreads] = {};
     size_t openblocks[MaxThreads][48];
 
     for(size_t i = lastframes[Frames+2]; i < lastframes[0]; ++i)
     {
-      auto entry = g_debuglog[(i + tail) % extentof(g_debuglog)];
+      auto &entry = log[i];
 
-      size_t threadindex = 0;
-      for(size_t i = 0; i < extentof(threads); ++i)
-      {
-        if (threads[i] == entry.thread)
-          threadindex = i;
-      }
+      size_t threadindex = entry.thread;
 
-      if (entry.type == DebugLogEntry::EnterBlock && entry.info)
+      if (entry.type == DebugLogEntry::EnterBlock && infoblock(entry.info))
       {
         assert(g_threads[threadindex].blockcount < MaxBlocks);
         assert(opencount[threadindex] < extentof(openblocks[0]));
 
         auto &block = g_threads[threadindex].blocks[g_threads[threadindex].blockcount];
 
-        block.info = entry.info;
+        block.info = infoblock(entry.info);
 
         block.beg = entry.timestamp;
 
@@ -296,23 +369,23 @@ namespace
 
     for(size_t i = lastframes[Frames+2]; i < lastframes[0]; ++i)
     {
-      auto entry = g_debuglog[(i + tail) % extentof(g_debuglog)];
+      auto &entry = log[i];
 
       if (entry.type == DebugLogEntry::GpuSubmit)
       {
         basetime = entry.timestamp;
       }
 
-      if (entry.type == DebugLogEntry::GpuBlock && entry.info)
+      if (entry.type == DebugLogEntry::GpuBlock && infoblock(entry.info))
       {
         assert(g_gpu.blockcount < MaxBlocks);
 
         auto &block = g_gpu.blocks[g_gpu.blockcount];
 
-        block.info = entry.info;
+        block.info = infoblock(entry.info);
 
         block.beg = basetime;
-        block.end = basetime = basetime + (unsigned long long)(entry.timestamp * 0.000000001 * clock_frequency());
+        block.end = basetime = basetime + (unsigned long long)(entry.duration * 0.000000001 * clock_frequency());
 
         g_gpu.blockcount += 1;
       }
@@ -322,9 +395,9 @@ namespace
     // Resources
     //
 
-    for(size_t i = 0; i < extentof(g_debuglog); ++i)
+    for(size_t i = 0; i < log.size(); ++i)
     {
-      auto &entry = g_debuglog[(i + tail) % extentof(g_debuglog)];
+      auto &entry = log[i];
 
       switch (entry.type)
       {
@@ -379,7 +452,7 @@ namespace
   ///////////////////////// push_debug_overlay //////////////////////////////
   void push_debug_overlay(RenderContext &context, ResourceManager &resources, PushBuffer &pushbuffer, DatumPlatform::Viewport const &viewport, Font const *font, Ui::Interaction *interaction)
   {
-    BEGIN_TIMED_BLOCK(DebugOverlay, Color3(1.0f, 0.0f, 0.0f))
+    BEGIN_TIMED_BLOCK(DebugOverlay, Color3(1.0f, 0.0f, 0.0f));
 
     SpriteList spritelist;
     SpriteList::BuildState buildstate;
@@ -637,6 +710,100 @@ namespace
           cursor += Vec2(0.0f, font->lineheight() + 2);
         }
 
+        //
+        // Profile
+        //
+
+        if (g_displayprofile)
+        {
+          spritelist.push_text(buildstate, cursor + Vec2(7, font->ascent), font->height(), font, "-", ishot(Ui::Interaction::ToggleProfile) ? Color4(1, 1, 0) : Color4(1, 1, 1));
+
+          if (contains(Rect2(cursor, cursor + Vec2(15, font->lineheight())), mousepos))
+            *interaction = { Ui::Interaction::ToggleProfile };
+
+          if (!g_profiling.load(std::memory_order_relaxed))
+          {
+            spritelist.push_text(buildstate, cursor + Vec2(20, font->ascent), font->height(), font, "Profiling Disabled");
+
+            cursor += Vec2(0.0f, font->lineheight() + 2);
+          }
+
+          ProfileStatistics statistics[64];
+
+          for(size_t i = 0, count = profile_statistics(statistics, extentof(statistics)); i < count; ++i)
+          {
+            auto &entry = statistics[i];
+
+            char buffer[256];
+            snprintf(buffer, sizeof(buffer), "%s: avg %.3f ms, p99 %.3f ms (min %.3f ms, max %.3f ms, %zu frames)", entry.name, 1000*entry.avg, 1000*entry.p99, 1000*entry.min, 1000*entry.max, entry.samples);
+
+            spritelist.push_text(buildstate, cursor + Vec2(20, font->ascent), font->height(), font, buffer);
+
+            cursor += Vec2(0.0f, font->lineheight() + 2);
+          }
+
+          cursor += Vec2(0.0f, 4.0f);
+        }
+        else
+        {
+          char buffer[] = "Profile";
+
+          spritelist.push_text(buildstate, cursor + Vec2(5, font->ascent), font->height(), font, buffer, ishot(Ui::Interaction::ToggleProfile) ? Color4(1, 1, 0) : Color4(1, 1, 1));
+
+          if (contains(Rect2(cursor, cursor + Vec2(font->width(buffer), font->lineheight())), mousepos))
+            *interaction = { Ui::Interaction::ToggleProfile };
+
+          cursor += Vec2(0.0f, font->lineheight() + 2);
+        }
+
+#ifdef ALLOCATION_TRACKING
+        //
+        // Arenas
+        //
+
+        if (g_displayarenas)
+        {
+          auto &tracker = allocation_tracker();
+
+          spritelist.push_text(buildstate, cursor + Vec2(7, font->ascent), font->height(), font, "-", ishot(Ui::Interaction::ToggleArenas) ? Color4(1, 1, 0) : Color4(1, 1, 1));
+
+          if (contains(Rect2(cursor, cursor + Vec2(15, font->lineheight())), mousepos))
+            *interaction = { Ui::Interaction::ToggleArenas };
+
+          for(size_t i = 0, end = min(tracker.count.load(), size_t(AllocationTracker::MaxArenas)); i < end; ++i)
+          {
+            auto &stats = tracker.arenas[i];
+
+            if (auto arena = stats.arena.load())
+            {
+              auto hits = stats.freelisthits.load();
+              auto misses = stats.freelistmisses.load();
+              auto freebytes = stats.freebytes.load();
+
+              char buffer[256];
+              snprintf(buffer, sizeof(buffer), "%s: %zu / %zu KiB (peak %zu KiB) allocs %zu, freelist %.0f%% hits, %zu KiB free (%.1f%%)", stats.tag, arena->size / 1024, arena->capacity / 1024, stats.highwater.load() / 1024, stats.allocations.load(), 100.0 * hits / max(hits + misses, size_t(1)), freebytes / 1024, 100.0 * freebytes / max(arena->size, size_t(1)));
+
+              spritelist.push_text(buildstate, cursor + Vec2(20, font->ascent), font->height(), font, buffer);
+
+              cursor += Vec2(0.0f, font->lineheight() + 2);
+            }
+          }
+
+          cursor += Vec2(0.0f, 4.0f);
+        }
+        else
+        {
+          char buffer[] = "Arenas";
+
+          spritelist.push_text(buildstate, cursor + Vec2(5, font->ascent), font->height(), font, buffer, ishot(Ui::Interaction::ToggleArenas) ? Color4(1, 1, 0) : Color4(1, 1, 1));
+
+          if (contains(Rect2(cursor, cursor + Vec2(font->width(buffer), font->lineheight())), mousepos))
+            *interaction = { Ui::Interaction::ToggleArenas };
+
+          cursor += Vec2(0.0f, font->lineheight() + 2);
+        }
+#endif
+
         //
         // Debug Menu
         //
@@ -752,11 +919,13 @@ namespace
       }
     }
 
-    END_TIMED_BLOCK(DebugOverlay)
+    END_TIMED_BLOCK(DebugOverlay);
   }
 
 }
 
+#endif
+
 ///////////////////////// DebugInfoBlock ////////////////////////////////////
 DebugInfoBlock::DebugInfoBlock(const char *name, const char *filename, int linenumber, Color3 color)
   : name(name), filename(filename), linenumber(linenumber), color(color)
@@ -769,12 +938,176 @@ DebugInfoBlock::DebugInfoBlock(const char *name, const char *filename, int linen
 
   g_infoblocks[g_infoblockcount] = this;
 
+  id = g_infoblockcount + 1;
+
   g_infoblockcount += 1;
 
   mutex.release();
 }
 
 
+///////////////////////// set_debuglog_capacity /////////////////////////////
+void set_debuglog_capacity(size_t entries)
+{
+  size_t capacity = 64;
+
+  while (capacity < entries)
+    capacity <<= 1;
+
+  g_debuglogcapacity = capacity;
+}
+
+
+///////////////////////// register_debuglog_buffer //////////////////////////
+DebugLogBuffer *register_debuglog_buffer()
+{
+  auto index = thread_index();
+
+  if (index >= extentof(g_debuglogbuffers))
+  {
+    static thread_local DebugLogEntry overflowentries[64];
+    static thread_local DebugLogBuffer overflow = { extentof(g_debuglogbuffers), extentof(overflowentries), {0}, {overflowentries} };
+
+    LOG_ONCE("Debug Log Thread Overflow")
+
+    return &overflow;
+  }
+
+  auto &buffer = g_debuglogbuffers[index];
+
+  buffer.thread = index;
+  buffer.capacity = g_debuglogcapacity;
+  buffer.tail.store(0, std::memory_order_relaxed);
+
+  // the release store publishes the fields above, readers acquire entries
+  // before touching the rest of the buffer
+
+  buffer.entries.store(new DebugLogEntry[buffer.capacity](), std::memory_order_release);
+
+  // threads are numbered process wide, so track the highest buffer in use
+
+  auto count = g_debuglogthreads.load();
+
+  while (count <= index && !g_debuglogthreads.compare_exchange_weak(count, index + 1))
+    ;
+
+  return &buffer;
+}
+
+
+///////////////////////// set_profiling /////////////////////////////////////
+void set_profiling(bool enabled)
+{
+  g_profiling.store(enabled, std::memory_order_relaxed);
+}
+
+
+///////////////////////// profile_frame /////////////////////////////////////
+void profile_frame()
+{
+  SyncLock M(g_profilemutex);
+
+  for(size_t thread = 0, count = min(g_debuglogthreads.load(), extentof(g_debuglogbuffers)); thread < count; ++thread)
+  {
+    auto &log = g_debuglogbuffers[thread];
+    auto &state = g_profilethreads[thread];
+
+    auto entries = log.entries.load(std::memory_order_acquire);
+
+    if (!entries)
+      continue;
+
+    size_t tail = log.tail.load(std::memory_order_acquire);
+
+    if (tail - state.lastentry > log.capacity)
+    {
+      state.depth = 0;
+      state.lastentry = tail - log.capacity;
+    }
+
+    for( ; state.lastentry < tail; ++state.lastentry)
+    {
+      auto &entry = entries[state.lastentry & (log.capacity - 1)];
+
+      if (entry.type == DebugLogEntry::EnterBlock)
+      {
+        if (state.depth < extentof(state.blocks))
+        {
+          state.blocks[state.depth].info = entry.info;
+          state.blocks[state.depth].beg = entry.timestamp;
+        }
+
+        state.depth += 1;
+      }
+
+      if (entry.type == DebugLogEntry::ExitBlock && state.depth > 0)
+      {
+        state.depth -= 1;
+
+        if (state.depth < extentof(state.blocks))
+        {
+          auto &block = state.blocks[state.depth];
+
+          if (block.info != 0 && block.info <= extentof(g_profileblocks) && block.beg <= entry.timestamp)
+          {
+            g_profileblocks[block.info - 1].frametime += entry.timestamp - block.beg;
+          }
+        }
+      }
+    }
+  }
+
+  for(size_t i = 0, end = min(g_infoblockcount.load(), extentof(g_profileblocks)); i < end; ++i)
+  {
+    g_profileblocks[i].samples[g_profileframe % ProfileFrames] = g_profileblocks[i].frametime;
+    g_profileblocks[i].frametime = 0;
+  }
+
+  g_profileframe += 1;
+}
+
+
+///////////////////////// profile_statistics ////////////////////////////////
+size_t profile_statistics(ProfileStatistics *statistics, size_t count)
+{
+  SyncLock M(g_profilemutex);
+
+  size_t result = 0;
+
+  for(size_t i = 0, end = min(g_infoblockcount.load(), extentof(g_profileblocks)); i < end && result < count; ++i)
+  {
+    size_t samplecount = 0;
+    unsigned long long samples[ProfileFrames];
+
+    for(size_t k = 0; k < min(g_profileframe, ProfileFrames); ++k)
+    {
+      if (g_profileblocks[i].samples[k] != 0)
+        samples[samplecount++] = g_profileblocks[i].samples[k];
+    }
+
+    if (samplecount == 0)
+      continue;
+
+    sort(samples, samples + samplecount);
+
+    unsigned long long total = 0;
+    for(size_t k = 0; k < samplecount; ++k)
+      total += samples[k];
+
+    auto &entry = statistics[result++];
+
+    entry.name = g_infoblocks[i]->name;
+    entry.samples = samplecount;
+    entry.min = samples[0] / clock_frequency();
+    entry.avg = total / samplecount / clock_frequency();
+    entry.max = samples[samplecount - 1] / clock_frequency();
+    entry.p99 = samples[(samplecount - 1) * 99 / 100] / clock_frequency();
+  }
+
+  return result;
+}
+
+
 ///////////////////////// cycle_frequency /////////////////////////////////
 double clock_frequency()
 {
@@ -806,6 +1139,8 @@ double clock_frequency()
 }
 
 
+#ifdef DEBUG
+
 ///////////////////////// dump //////////////////////////////////////////////
 void dump(const char *name, Arena const &arena)
 {
@@ -818,11 +1153,11 @@ void dump(const char *name, FreeList const &freelist)
 {
   cout << "Freelist: " << name;
 
-  for(size_t index = 0; index < extentof(freelist.m_freelist); ++index)
+  for(size_t index = 0; index < FreeList::Buckets; ++index)
   {
     size_t nodes = 0;
 
-    void *entry = freelist.m_freelist[index];
+    void *entry = freelist.m_head[index];
 
     while (entry != nullptr)
     {
@@ -986,6 +1321,14 @@ void update_debug_overlay(GameInput const &input, bool *accepted)
           g_displayframegraph = !g_displayframegraph;
           break;
 
+        case Ui::Interaction::ToggleProfile:
+          g_displayprofile = !g_displayprofile;
+          break;
+
+        case Ui::Interaction::ToggleArenas:
+          g_displayarenas = !g_displayarenas;
+          break;
+
         case Ui::Interaction::ToggleGroup:
           g_menu.groups[interaction.id].expanded = !g_menu.groups[interaction.id].expanded;
           break;
@@ -1033,13 +1376,15 @@ void render_debug_overlay(RenderContext &context, ResourceManager &resources, Pu
   g_interaction.nexthot = interaction;
 }
 
+#endif
+
 
 ///////////////////////// stream_debuglog ///////////////////////////////////
 void stream_debuglog(const char *filename)
 {
   static ofstream fout;
   static size_t lastinfo;
-  static size_t lastentry;
+  static size_t lastentry[extentof(g_debuglogbuffers)];
 
   if (!fout.is_open())
   {
@@ -1053,7 +1398,13 @@ void stream_debuglog(const char *filename)
     fout.write((const char *)&header, sizeof(header));
 
     lastinfo = 0;
-    lastentry = max(g_debuglogtail.load(), extentof(g_debuglog)) - extentof(g_debuglog);
+
+    for(size_t i = 0; i < extentof(lastentry); ++i)
+    {
+      auto &log = g_debuglogbuffers[i];
+
+      lastentry[i] = log.entries.load(std::memory_order_acquire) ? max(log.tail.load(), log.capacity) - log.capacity : 0;
+    }
   }
 
   char buffer[8192];
@@ -1066,7 +1417,7 @@ void stream_debuglog(const char *filename)
 
     DebugLogInfoChunk *infochunk = (DebugLogInfoChunk *)(buffer + sizeof(DebugLogChunk));
 
-    infochunk->id = g_infoblocks[lastinfo];
+    infochunk->id = g_infoblocks[lastinfo]->id;
     strlcpy(infochunk->name, g_infoblocks[lastinfo]->name, sizeof(infochunk->name));
     strlcpy(infochunk->filename, g_infoblocks[lastinfo]->filename, sizeof(infochunk->filename));
     infochunk->linenumber = g_infoblocks[lastinfo]->linenumber;
@@ -1075,29 +1426,74 @@ void stream_debuglog(const char *filename)
     fout.write(buffer, sizeof(DebugLogChunk) + chunk->length);
   }
 
-  size_t tail = max(g_debuglogtail.load(), size_t(32)) - 32;
-
-  for(size_t end = tail; lastentry < end; )
+  for(size_t thread = 0, count = min(g_debuglogthreads.load(), extentof(g_debuglogbuffers)); thread < count; ++thread)
   {
-    constexpr size_t MaxEntries = (sizeof(buffer) - sizeof(DebugLogChunk) - sizeof(DebugLogEntryChunk)) / sizeof(DebugLogEntry);
+    auto &log = g_debuglogbuffers[thread];
 
-    DebugLogChunk *chunk = (DebugLogChunk *)buffer;
-    chunk->type = 2;
-    chunk->length = sizeof(DebugLogEntryChunk) - sizeof(DebugLogEntry);
+    auto entries = log.entries.load(std::memory_order_acquire);
+
+    if (!entries)
+      continue;
+
+    // hold back the most recent entries, they may still be being written
+
+    size_t tail = max(log.tail.load(std::memory_order_acquire), size_t(4)) - 4;
 
-    DebugLogEntryChunk *entrychunk = (DebugLogEntryChunk *)(buffer + sizeof(DebugLogChunk));
-    entrychunk->entrycount = 0;
+    lastentry[thread] = max(lastentry[thread], max(tail, log.capacity) - log.capacity);
 
-    for(size_t i = 0, end = min(tail - lastentry, MaxEntries); i < end; ++i, ++lastentry)
+    for(size_t end = tail; lastentry[thread] < end; )
     {
-      entrychunk->entrycount += 1;
-      entrychunk->entries[i] = g_debuglog[lastentry % extentof(g_debuglog)];
+      constexpr size_t MaxEntries = (sizeof(buffer) - sizeof(DebugLogChunk) - sizeof(DebugLogEntryChunk)) / sizeof(DebugLogEntry);
 
-      chunk->length += sizeof(DebugLogEntry);
+      DebugLogChunk *chunk = (DebugLogChunk *)buffer;
+      chunk->type = 2;
+      chunk->length = sizeof(DebugLogEntryChunk) - sizeof(DebugLogEntry);
+
+      DebugLogEntryChunk *entrychunk = (DebugLogEntryChunk *)(buffer + sizeof(DebugLogChunk));
+      entrychunk->entrycount = 0;
+
+      for(size_t i = 0, end = min(tail - lastentry[thread], MaxEntries); i < end; ++i, ++lastentry[thread])
+      {
+        entrychunk->entrycount += 1;
+        entrychunk->entries[i] = entries[lastentry[thread] & (log.capacity - 1)];
+
+        chunk->length += sizeof(DebugLogEntry);
+      }
+
+      fout.write(buffer, sizeof(DebugLogChunk) + chunk->length);
     }
+  }
 
-    fout.write(buffer, sizeof(DebugLogChunk) + chunk->length);
+#ifdef ALLOCATION_TRACKING
+  auto &tracker = allocation_tracker();
+
+  for(size_t i = 0, end = min(tracker.count.load(), size_t(AllocationTracker::MaxArenas)); i < end; ++i)
+  {
+    auto &stats = tracker.arenas[i];
+
+    if (auto arena = stats.arena.load())
+    {
+      DebugLogChunk *chunk = (DebugLogChunk *)buffer;
+      chunk->type = 3;
+      chunk->length = sizeof(DebugLogArenaChunk);
+
+      DebugLogArenaChunk *arenachunk = (DebugLogArenaChunk *)(buffer + sizeof(DebugLogChunk));
+
+      arenachunk->timestamp = __rdtsc() - g_debuglogbase;
+      strlcpy(arenachunk->tag, stats.tag, sizeof(arenachunk->tag));
+      arenachunk->capacity = arena->capacity;
+      arenachunk->size = arena->size;
+      arenachunk->highwater = stats.highwater;
+      arenachunk->allocations = stats.allocations;
+      arenachunk->allocatedbytes = stats.allocatedbytes;
+      arenachunk->freelisthits = stats.freelisthits;
+      arenachunk->freelistmisses = stats.freelistmisses;
+      arenachunk->freebytes = stats.freebytes;
+
+      fout.write(buffer, sizeof(DebugLogChunk) + chunk->length);
+    }
   }
+#endif
 }
 
 #endif
@@ -19,7 +19,7 @@
 #define DEBUG
 #endif
 
-#ifdef DEBUG
+#if defined(DEBUG) || defined(PROFILING)
 #include <atomic>
 #include <thread>
 #include "math/color.h"
@@ -30,25 +30,6 @@
 #include <x86intrin.h>
 #endif
 
-#if 0
-inline __attribute__((always_inline)) void *operator new(std::size_t)
-{
-  assert(false);
-
-  throw std::bad_alloc();
-}
-
-inline __attribute__((always_inline)) void operator delete(void *ptr) noexcept
-{
-  assert(false);
-}
-
-inline __attribute__((always_inline)) void operator delete(void *ptr, size_t) noexcept
-{
-  assert(false);
-}
-#endif
-
 //
 // Timing
 //
@@ -60,6 +41,8 @@ struct DebugInfoBlock
   int linenumber;
   lml::Color3 color;
 
+  uint32_t id;
+
   DebugInfoBlock(const char *name, const char *filename, int linenumber, lml::Color3 color);
 };
 
@@ -83,13 +66,13 @@ struct DebugLogEntry
     HitCount
   };
 
-  EntryType type;
-  std::thread::id thread;
-  unsigned long long timestamp;
+  unsigned long long timestamp : 52;
+  unsigned long long type : 6;
+  unsigned long long thread : 6;
 
   union
-  {     
-    size_t hitcount;
+  {
+    uint64_t hitcount;
 
     struct
     {
@@ -97,128 +80,150 @@ struct DebugLogEntry
       uint32_t resourcecapacity;
     };
 
-    DebugInfoBlock const *info;
+    struct
+    {
+      uint32_t info;
+      uint32_t duration;
+    };
   };
 };
 
-extern DebugLogEntry g_debuglog[4096];
-extern std::atomic<size_t> g_debuglogtail;
+static_assert(sizeof(DebugLogEntry) == 16, "DebugLogEntry size");
+
+struct DebugLogBuffer
+{
+  size_t thread;
+  size_t capacity;
+
+  std::atomic<size_t> tail;
+
+  std::atomic<DebugLogEntry*> entries; // published last, readers acquire
+};
+
+extern DebugLogBuffer g_debuglogbuffers[32];
+extern std::atomic<size_t> g_debuglogthreads;
+extern unsigned long long g_debuglogbase;
+extern std::atomic<bool> g_profiling;
 
 double clock_frequency();
 
+void set_debuglog_capacity(size_t entries);
+
+DebugLogBuffer *register_debuglog_buffer();
+
+inline void debuglog_entry(DebugLogEntry::EntryType type, unsigned long long timestamp, DebugLogEntry entry = {})
+{
+  static thread_local DebugLogBuffer *buffer = register_debuglog_buffer();
+
+  auto tail = buffer->tail.load(std::memory_order_relaxed);
+
+  entry.type = type;
+  entry.thread = buffer->thread;
+  entry.timestamp = timestamp - g_debuglogbase;
+
+  // the entry is complete before the tail publishes it to readers
+
+  buffer->entries.load(std::memory_order_relaxed)[tail & (buffer->capacity - 1)] = entry;
+
+  buffer->tail.store(tail + 1, std::memory_order_release);
+}
+
 #define BEGIN_FRAME() \
-  {                                                                                        \
-    unsigned int p;                                                                        \
-    size_t entry = g_debuglogtail.fetch_add(1) % std::extent<decltype(g_debuglog)>::value; \
-    g_debuglog[entry].type = DebugLogEntry::FrameMarker;                                   \
-    g_debuglog[entry].thread = std::this_thread::get_id();                                 \
-    g_debuglog[entry].timestamp = __rdtscp(&p);                                            \
-  }
+  do {                                                                                     \
+    if (g_profiling.load(std::memory_order_relaxed))                                       \
+    {                                                                                      \
+      unsigned int p;                                                                      \
+      debuglog_entry(DebugLogEntry::FrameMarker, __rdtscp(&p));                            \
+      profile_frame();                                                                     \
+    }                                                                                      \
+  } while (0)
 
 #define BEGIN_TIMED_BLOCK(name, color) \
-  {                                                                                        \
-    static const DebugInfoBlock blockinfo(#name, __FILE__, __LINE__, color);               \
-    size_t entry = g_debuglogtail.fetch_add(1) % std::extent<decltype(g_debuglog)>::value; \
-    g_debuglog[entry].info = &blockinfo;                                                   \
-    g_debuglog[entry].type = DebugLogEntry::EnterBlock;                                    \
-    g_debuglog[entry].thread = std::this_thread::get_id();                                 \
-    g_debuglog[entry].timestamp = __rdtsc();                                               \
-  }
+  do {                                                                                     \
+    if (g_profiling.load(std::memory_order_relaxed))                                       \
+    {                                                                                      \
+      static const DebugInfoBlock blockinfo(#name, __FILE__, __LINE__, color);             \
+      DebugLogEntry entry = {};                                                            \
+      entry.info = blockinfo.id;                                                           \
+      debuglog_entry(DebugLogEntry::EnterBlock, __rdtsc(), entry);                         \
+    }                                                                                      \
+  } while (0)
 
 #define END_TIMED_BLOCK(name) \
-  {                                                                                        \
-    size_t entry = g_debuglogtail.fetch_add(1) % std::extent<decltype(g_debuglog)>::value; \
-    g_debuglog[entry].type = DebugLogEntry::ExitBlock;                                     \
-    g_debuglog[entry].thread = std::this_thread::get_id();                                 \
-    g_debuglog[entry].timestamp = __rdtsc();                                               \
-  }
+  do {                                                                                     \
+    if (g_profiling.load(std::memory_order_relaxed))                                       \
+    {                                                                                      \
+      debuglog_entry(DebugLogEntry::ExitBlock, __rdtsc());                                 \
+    }                                                                                      \
+  } while (0)
 
 #define GPU_SUBMIT() \
-  {                                                                                        \
-    size_t entry = g_debuglogtail.fetch_add(1) % std::extent<decltype(g_debuglog)>::value; \
-    g_debuglog[entry].type = DebugLogEntry::GpuSubmit;                                     \
-    g_debuglog[entry].thread = std::this_thread::get_id();                                 \
-    g_debuglog[entry].timestamp = __rdtsc();                                               \
-  }
+  do {                                                                                     \
+    if (g_profiling.load(std::memory_order_relaxed))                                       \
+    {                                                                                      \
+      debuglog_entry(DebugLogEntry::GpuSubmit, __rdtsc());                                 \
+    }                                                                                      \
+  } while (0)
 
 #define GPU_TIMED_BLOCK(name, color, start, finish) \
-  {                                                                                        \
-    static const DebugInfoBlock blockinfo(#name, __FILE__, __LINE__, color);               \
-    size_t entry = g_debuglogtail.fetch_add(1) % std::extent<decltype(g_debuglog)>::value; \
-    g_debuglog[entry].info = &blockinfo;                                                   \
-    g_debuglog[entry].type = DebugLogEntry::GpuBlock;                                      \
-    g_debuglog[entry].thread = std::this_thread::get_id();                                 \
-    g_debuglog[entry].timestamp = (finish) - (start);                                      \
-  }
+  do {                                                                                     \
+    if (g_profiling.load(std::memory_order_relaxed))                                       \
+    {                                                                                      \
+      static const DebugInfoBlock blockinfo(#name, __FILE__, __LINE__, color);             \
+      DebugLogEntry entry = {};                                                            \
+      entry.info = blockinfo.id;                                                           \
+      entry.duration = (uint32_t)((finish) - (start));                                     \
+      debuglog_entry(DebugLogEntry::GpuBlock, __rdtsc(), entry);                           \
+    }                                                                                      \
+  } while (0)
 
 //
 // Statistics
 //
 
 #define RESOURCE_USE(name, used, capacity) \
-  {                                                                                        \
-    size_t entry = g_debuglogtail.fetch_add(1) % std::extent<decltype(g_debuglog)>::value; \
-    g_debuglog[entry].type = DebugLogEntry::name;                                          \
-    g_debuglog[entry].thread = std::this_thread::get_id();                                 \
-    g_debuglog[entry].timestamp = __rdtsc();                                               \
-    g_debuglog[entry].resourceused = used;                                                 \
-    g_debuglog[entry].resourcecapacity = capacity;                                         \
-  }
+  do {                                                                                     \
+    auto resourceused = (used);                                                            \
+    if (g_profiling.load(std::memory_order_relaxed))                                       \
+    {                                                                                      \
+      DebugLogEntry entry = {};                                                            \
+      entry.resourceused = resourceused;                                                   \
+      entry.resourcecapacity = capacity;                                                   \
+      debuglog_entry(DebugLogEntry::name, __rdtsc(), entry);                               \
+    }                                                                                      \
+  } while (0)
 
 #define STATISTIC_HIT(name, count) \
-  {                                                                                        \
-    size_t entry = g_debuglogtail.fetch_add(1) % std::extent<decltype(g_debuglog)>::value; \
-    g_debuglog[entry].type = DebugLogEntry::HitCount;                                      \
-    g_debuglog[entry].thread = std::this_thread::get_id();                                 \
-    g_debuglog[entry].timestamp = __rdtsc();                                               \
-    g_debuglog[entry].hitcount = count;                                                    \
-  }
-
-//
-// Logging
-//
-
-#define LOG_ONCE(msg) \
-  {                                                                                        \
-    static bool logged = false;                                                            \
-    if (!logged)                                                                           \
+  do {                                                                                     \
+    if (g_profiling.load(std::memory_order_relaxed))                                       \
     {                                                                                      \
-      std::cout << (msg) << std::endl;                                                     \
-      logged = true;                                                                       \
+      DebugLogEntry entry = {};                                                            \
+      entry.hitcount = count;                                                              \
+      debuglog_entry(DebugLogEntry::HitCount, __rdtsc(), entry);                           \
     }                                                                                      \
-  }
+  } while (0)
 
 //
-// Memory
+// Profiling
 //
 
-void dump(const char *name, Arena const &arena);
-void dump(const char *name, FreeList const &freelist);
-
-
-//
-// Menu
-//
-
-template<typename T>
-void debug_menu_entry(const char *name, T const &value);
-
-template<typename T>
-T debug_menu_value(const char *name, T const &value, T const &min, T const &max);
+struct ProfileStatistics
+{
+  const char *name;
 
-#define DEBUG_MENU_ENTRY(name, value) \
-  debug_menu_entry(name, value);
+  size_t samples;
 
-#define DEBUG_MENU_VALUE(name, value, min, max) \
-  debug_menu_entry(name, *(value) = debug_menu_value(name, *(value), min, max));
+  double min;
+  double avg;
+  double max;
+  double p99;
+};
 
+void set_profiling(bool enabled);
 
-//
-// Interface
-//
+void profile_frame();
 
-void update_debug_overlay(struct DatumPlatform::GameInput const &input, bool *accepted);
-void render_debug_overlay(struct RenderContext &context, class ResourceManager &resources, class PushBuffer &pushbuffer, struct DatumPlatform::Viewport const &viewport, class Font const *font);
+size_t profile_statistics(ProfileStatistics *statistics, size_t count);
 
 
 //
@@ -230,6 +235,7 @@ void render_debug_overlay(struct RenderContext &context, class ResourceManager &
 struct DebugLogHeader
 {
   uint32_t magic = 0x44544d44;
+  uint32_t version = 2;
 
   double clockfrequency;
 };
@@ -242,7 +248,7 @@ struct DebugLogChunk
 
 struct DebugLogInfoChunk // type = 1
 {
-  DebugInfoBlock const *id;
+  uint32_t id;
 
   char name[256];
   char filename[512];
@@ -256,24 +262,114 @@ struct DebugLogEntryChunk // type = 2
   DebugLogEntry entries[1];
 };
 
+struct DebugLogArenaChunk // type = 3
+{
+  unsigned long long timestamp;
+
+  char tag[32];
+
+  uint64_t capacity;
+  uint64_t size;
+  uint64_t highwater;
+  uint64_t allocations;
+  uint64_t allocatedbytes;
+  uint64_t freelisthits;
+  uint64_t freelistmisses;
+  uint64_t freebytes;
+};
+
 #pragma pack(pop)
 
 void stream_debuglog(const char *filename);
 
 #endif
 
-#ifdef NDEBUG
-#define BEGIN_FRAME(...)
-#define BEGIN_TIMED_BLOCK(...)
-#define END_TIMED_BLOCK(...)
-#define GPU_SUBMIT(...)
-#define GPU_TIMED_BLOCK(...)
-#define RESOURCE_USE(...)
-#define STATISTIC_HIT(...)
+#ifdef DEBUG
+
+#if 0
+inline __attribute__((always_inline)) void *operator new(std::size_t)
+{
+  assert(false);
+
+  throw std::bad_alloc();
+}
+
+inline __attribute__((always_inline)) void operator delete(void *ptr) noexcept
+{
+  assert(false);
+}
+
+inline __attribute__((always_inline)) void operator delete(void *ptr, size_t) noexcept
+{
+  assert(false);
+}
+#endif
+
+//
+// Logging
+//
+
+#define LOG_ONCE(msg) \
+  {                                                                                        \
+    static bool logged = false;                                                            \
+    if (!logged)                                                                           \
+    {                                                                                      \
+      std::cout << (msg) << std::endl;                                                     \
+      logged = true;                                                                       \
+    }                                                                                      \
+  }
+
+//
+// Memory
+//
+
+void dump(const char *name, Arena const &arena);
+void dump(const char *name, FreeList const &freelist);
+
+
+//
+// Menu
+//
+
+template<typename T>
+void debug_menu_entry(const char *name, T const &value);
+
+template<typename T>
+T debug_menu_value(const char *name, T const &value, T const &min, T const &max);
+
+#define DEBUG_MENU_ENTRY(name, value) \
+  debug_menu_entry(name, value);
+
+#define DEBUG_MENU_VALUE(name, value, min, max) \
+  debug_menu_entry(name, *(value) = debug_menu_value(name, *(value), min, max));
+
+
+//
+// Interface
+//
+
+void update_debug_overlay(struct DatumPlatform::GameInput const &input, bool *accepted);
+void render_debug_overlay(struct RenderContext &context, class ResourceManager &resources, class PushBuffer &pushbuffer, struct DatumPlatform::Viewport const &viewport, class Font const *font);
+
+#endif
+
+#if !defined(DEBUG) && !defined(PROFILING)
+#define BEGIN_FRAME(...) do { } while (0)
+#define BEGIN_TIMED_BLOCK(...) do { } while (0)
+#define END_TIMED_BLOCK(...) do { } while (0)
+#define GPU_SUBMIT(...) do { } while (0)
+#define GPU_TIMED_BLOCK(...) do { } while (0)
+#define RESOURCE_USE(...) do { } while (0)
+#define STATISTIC_HIT(...) do { } while (0)
+#define set_profiling(...) do { } while (0)
+#define set_debuglog_capacity(...) do { } while (0)
+#define stream_debuglog(...) do { } while (0)
+#endif
+
+#ifndef DEBUG
 #define LOG_ONCE(...)
 #define DEBUG_MENU_ENTRY(...)
 #define DEBUG_MENU_VALUE(...)
 #define update_debug_overlay(...)
 #define render_debug_overlay(...)
-#define stream_debuglog(...)
 #endif
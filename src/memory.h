@@ -12,12 +12,156 @@
 #include <memory>
 #include <algorithm>
 #include <scoped_allocator>
+#include <atomic>
 #include <cassert>
 
 // Arena
 
 using Arena = DatumPlatform::GameMemory;
 
+// Allocation Tracking
+
+#ifdef ALLOCATION_TRACKING
+
+struct ArenaStatistics
+{
+  const char *tag;
+
+  std::atomic<Arena const *> arena;
+
+  std::atomic<size_t> allocations;
+  std::atomic<size_t> allocatedbytes;
+  std::atomic<size_t> highwater;
+
+  std::atomic<size_t> freelisthits;
+  std::atomic<size_t> freelistmisses;
+  std::atomic<size_t> freebytes;
+};
+
+struct AllocationTracker
+{
+  static constexpr size_t MaxArenas = 32;
+
+  std::atomic<size_t> count;
+
+  ArenaStatistics arenas[MaxArenas];
+};
+
+inline AllocationTracker &allocation_tracker()
+{
+  static AllocationTracker tracker;
+
+  return tracker;
+}
+
+inline void track_arena(Arena const &arena, const char *tag)
+{
+  auto &tracker = allocation_tracker();
+
+  auto index = tracker.count.fetch_add(1);
+
+  assert(index < AllocationTracker::MaxArenas);
+
+  if (index < AllocationTracker::MaxArenas)
+  {
+    tracker.arenas[index].tag = tag;
+    tracker.arenas[index].highwater = arena.size;
+    tracker.arenas[index].arena = &arena;
+  }
+}
+
+inline ArenaStatistics *arena_statistics(Arena const &arena)
+{
+  auto &tracker = allocation_tracker();
+
+  for(size_t i = 0, end = std::min(tracker.count.load(), size_t(AllocationTracker::MaxArenas)); i < end; ++i)
+  {
+    if (tracker.arenas[i].arena == &arena)
+      return &tracker.arenas[i];
+  }
+
+  return nullptr;
+}
+
+inline ArenaStatistics *arena_statistics(void const *ptr)
+{
+  ArenaStatistics *result = nullptr;
+
+  auto &tracker = allocation_tracker();
+
+  for(size_t i = 0, end = std::min(tracker.count.load(), size_t(AllocationTracker::MaxArenas)); i < end; ++i)
+  {
+    auto arena = tracker.arenas[i].arena.load();
+
+    if (arena && arena->data <= ptr && ptr < (void const *)((char const *)arena->data + arena->capacity))
+    {
+      // slabs carved from a tracked arena win over their parent
+
+      if (!result || arena->capacity < result->arena.load()->capacity)
+        result = &tracker.arenas[i];
+    }
+  }
+
+  return result;
+}
+
+inline void track_allocation(Arena const &arena, size_t bytes)
+{
+  if (auto stats = arena_statistics(arena))
+  {
+    stats->allocations += 1;
+    stats->allocatedbytes += bytes;
+
+    auto size = arena.size;
+    auto highwater = stats->highwater.load(std::memory_order_relaxed);
+
+    while (highwater < size && !stats->highwater.compare_exchange_weak(highwater, size))
+      ;
+  }
+}
+
+inline void track_reclaim(void const *ptr, size_t bytes)
+{
+  if (auto stats = arena_statistics(ptr))
+  {
+    stats->freebytes -= std::min(bytes, stats->freebytes.load());
+  }
+}
+
+inline void track_freelist_hit(void const *ptr, size_t bytes)
+{
+  if (auto stats = arena_statistics(ptr))
+  {
+    stats->freelisthits += 1;
+  }
+
+  track_reclaim(ptr, bytes);
+}
+
+inline void track_freelist_miss(Arena const &arena)
+{
+  if (auto stats = arena_statistics(arena))
+  {
+    stats->freelistmisses += 1;
+  }
+}
+
+inline void track_release(void const *ptr, size_t bytes)
+{
+  if (auto stats = arena_statistics(ptr))
+  {
+    stats->freebytes += bytes;
+  }
+}
+
+#define TRACK_ARENA(arena, tag) track_arena(arena, tag);
+
+#else
+
+#define TRACK_ARENA(...)
+
+#endif
+
 //|---------------------- StackAllocator ------------------------------------
 //|--------------------------------------------------------------------------
 
@@ -79,6 +223,10 @@ T *StackAllocator<T>::allocate(std::size_t n, std::size_t alignment, std::size_t
 
   m_arena->size = static_cast<char*>(result) + bytes - static_cast<char*>(m_arena->data);
 
+#ifdef ALLOCATION_TRACKING
+  track_allocation(*m_arena, bytes);
+#endif
+
   return static_cast<T*>(result);
 }
 
@@ -122,30 +270,53 @@ class FreeList
 
     void siphon(FreeList *other);
 
+    void coalesce(Arena &arena);
+
   public:
 
+    static constexpr size_t Buckets = 152;
+
+    // size classes are 16 bytes apart up to 128, then 8 per power of two
+
     static size_t bucket(size_t n)
     {
-#if defined(_MSC_VER) && defined(_WIN64)
-      auto __builtin_clzll = [](unsigned long long mask)
-      {
-        unsigned long where = 0;
+      if (n <= 128)
+        return (std::max(n, size_t(1)) - 1) >> 4;
 
-        _BitScanReverse64(&where, mask);
+      auto bits = msb(n - 1);
 
-        return 63 - where;
-      };
-#endif
+      return std::min(8 + ((bits - 7) << 3) + (((n - 1) >> (bits - 3)) & 7), Buckets - 1);
+    }
 
-      auto bits = (8*sizeof(unsigned long long) - __builtin_clzll(n | 128) - 3);
-      auto mask = (1 << bits) - 1;
+    static size_t bucket_size(size_t index)
+    {
+      if (index < 8)
+        return (index + 1) << 4;
 
-      return std::min(((bits - 5) << 2) + ((n + mask) >> bits), std::extent<decltype(m_freelist)>::value) - 1;
+      return (9 + ((index - 8) & 7)) << (((index - 8) >> 3) + 4);
     }
 
     static size_t bucket_mask(size_t n)
     {
-      return (1 << ((bucket(n) >> 2) + 5)) - 1;
+      if (n <= 128)
+        return 15;
+
+      return (size_t(1) << (msb(n - 1) - 3)) - 1;
+    }
+
+  private:
+
+    static size_t msb(size_t n)
+    {
+#if defined(_MSC_VER) && defined(_WIN64)
+      unsigned long where = 0;
+
+      _BitScanReverse64(&where, n);
+
+      return where;
+#else
+      return 8*sizeof(unsigned long long) - 1 - __builtin_clzll(n);
+#endif
     }
 
   private:
@@ -158,13 +329,17 @@ class FreeList
     };
 
     template<typename U>
-    U *node_cast(void *ptr)
+    static U *node_cast(void *ptr)
     {
       return reinterpret_cast<U*>((reinterpret_cast<uintptr_t>(ptr) + alignof(U) - 1) & -alignof(U));
     }
 
-    void *m_freelist[24] = {};
+    static void *sort(void *list);
 
+    void *m_head[Buckets] = {};
+    void *m_tail[Buckets] = {};
+
+    friend class ConcurrentFreeList;
     friend void dump(const char *name, FreeList const &freelist);
 };
 
@@ -174,21 +349,30 @@ inline void *FreeList::acquire(std::size_t bytes, std::size_t alignment)
 {
   auto index = bucket(bytes);
 
-  void *entry = m_freelist[index];
-  void **into = &m_freelist[index];
+  void *prev = nullptr;
+  void *entry = m_head[index];
 
-  while (entry != nullptr)
+  // every block in a class fits the request, so only alignment (or the
+  // open ended last class) can force a short search
+
+  for(int probe = 0; entry != nullptr && probe < 4; ++probe)
   {
     auto node = node_cast<Node>(entry);
 
-    if (node->bytes == bytes && (reinterpret_cast<uintptr_t>(entry) & (alignment-1)) == 0)
+    if (node->bytes >= bytes && (reinterpret_cast<uintptr_t>(entry) & (alignment-1)) == 0)
     {
-      *into = node->next;
+      if (prev)
+        node_cast<Node>(prev)->next = node->next;
+      else
+        m_head[index] = node->next;
+
+      if (m_tail[index] == entry)
+        m_tail[index] = prev;
 
       return entry;
     }
 
-    into = &node->next;
+    prev = entry;
     entry = node->next;
   }
 
@@ -201,14 +385,20 @@ inline void FreeList::release(void *ptr, std::size_t bytes) noexcept
 {
   auto node = node_cast<Node>(ptr);
 
-  if ((char*)node + sizeof(Node) < (char*)ptr + bytes)
+  if ((char*)node + sizeof(Node) <= (char*)ptr + bytes)
   {
     auto index = bucket(bytes);
 
+    if (bucket_size(index) > bytes)
+      index -= 1;
+
     node->bytes = bytes;
-    node->next = m_freelist[index];
+    node->next = m_head[index];
+
+    if (m_head[index] == nullptr)
+      m_tail[index] = ptr;
 
-    m_freelist[index] = ptr;
+    m_head[index] = ptr;
   }
 }
 
@@ -216,27 +406,279 @@ inline void FreeList::release(void *ptr, std::size_t bytes) noexcept
 ///////////////////////// Freelist::siphon //////////////////////////////////
 inline void FreeList::siphon(FreeList *other)
 {
-  for(size_t index = 0; index < std::extent<decltype(m_freelist)>::value; ++index)
+  for(size_t index = 0; index < Buckets; ++index)
+  {
+    if (other->m_head[index] != nullptr)
+    {
+      node_cast<Node>(other->m_tail[index])->next = m_head[index];
+
+      if (m_head[index] == nullptr)
+        m_tail[index] = other->m_tail[index];
+
+      m_head[index] = other->m_head[index];
+
+      other->m_head[index] = nullptr;
+      other->m_tail[index] = nullptr;
+    }
+  }
+}
+
+
+///////////////////////// Freelist::sort ////////////////////////////////////
+inline void *FreeList::sort(void *list)
+{
+  auto merge = [](void *a, void *b) {
+
+    void *result = nullptr;
+    void **into = &result;
+
+    while (a != nullptr && b != nullptr)
+    {
+      auto &next = (a < b) ? a : b;
+
+      *into = next;
+      into = &node_cast<Node>(next)->next;
+      next = *into;
+    }
+
+    *into = (a != nullptr) ? a : b;
+
+    return result;
+  };
+
+  void *bins[64] = {};
+
+  while (list != nullptr)
+  {
+    void *carry = list;
+
+    list = node_cast<Node>(carry)->next;
+    node_cast<Node>(carry)->next = nullptr;
+
+    size_t i = 0;
+    for( ; bins[i] != nullptr; ++i)
+    {
+      carry = merge(bins[i], carry);
+      bins[i] = nullptr;
+    }
+
+    bins[i] = carry;
+  }
+
+  void *result = nullptr;
+
+  for(size_t i = 0; i < std::extent<decltype(bins)>::value; ++i)
+  {
+    if (bins[i] != nullptr)
+      result = merge(bins[i], result);
+  }
+
+  return result;
+}
+
+
+///////////////////////// Freelist::coalesce ////////////////////////////////
+inline void FreeList::coalesce(Arena &arena)
+{
+  void *list = nullptr;
+
+  for(size_t index = 0; index < Buckets; ++index)
+  {
+    if (m_head[index] != nullptr)
+    {
+      node_cast<Node>(m_tail[index])->next = list;
+
+      list = m_head[index];
+
+      m_head[index] = nullptr;
+      m_tail[index] = nullptr;
+    }
+  }
+
+  list = sort(list);
+
+  while (list != nullptr)
+  {
+    auto start = static_cast<char*>(list);
+    auto bytes = node_cast<Node>(list)->bytes;
+
+    list = node_cast<Node>(list)->next;
+
+    while (list == start + bytes)
+    {
+      bytes += node_cast<Node>(list)->bytes;
+
+      list = node_cast<Node>(list)->next;
+    }
+
+    // a run at the top of the arena is handed back to the arena itself
+
+    if (start + bytes == static_cast<char*>(arena.data) + arena.size && arena.data <= start)
+    {
+#ifdef ALLOCATION_TRACKING
+      track_reclaim(start, bytes);
+#endif
+
+      arena.size = start - static_cast<char*>(arena.data);
+
+      continue;
+    }
+
+    // otherwise split into the largest size classes that fit
+
+    while (bytes >= sizeof(Node))
+    {
+      auto index = bucket(bytes);
+
+      if (bucket_size(index) > bytes)
+        index -= 1;
+
+      auto piece = (index == Buckets - 1) ? bytes : bucket_size(index);
+
+      release(start, piece);
+
+      start += piece;
+      bytes -= piece;
+    }
+  }
+}
+
+
+
+///////////////////////// thread_index //////////////////////////////////////
+// Process wide thread number, handed out on first use. Every per-thread table
+// (work deques, thread arenas, debug logs, resource lumps) is indexed by it.
+inline size_t thread_index()
+{
+  static std::atomic<size_t> count(0);
+  static thread_local size_t index = count++;
+
+  return index;
+}
+
+
+
+//|---------------------- ConcurrentFreeList --------------------------------
+//|--------------------------------------------------------------------------
+
+// The owning thread (the one that constructs the list) allocates, any thread
+// may release. Foreign releases are pushed onto a lock free return list that
+// the owner reclaims in batches, so there is never more than one consumer.
+
+class ConcurrentFreeList
+{
+  public:
+
+    ConcurrentFreeList() = default;
+
+    ConcurrentFreeList(ConcurrentFreeList const &) = delete;
+    ConcurrentFreeList &operator=(ConcurrentFreeList const &) = delete;
+
+    FreeList &local() { return m_local; }
+
+    void *acquire(std::size_t bytes, std::size_t alignment);
+
+    void release(void *ptr, std::size_t bytes) noexcept;
+
+    void release(FreeList &cache) noexcept;
+
+    void reclaim();
+
+  private:
+
+    void push(void *first, void *last) noexcept;
+
+    FreeList m_local;
+
+    std::size_t m_owner = thread_index();
+
+    std::atomic<void*> m_returned = { nullptr };
+};
+
+
+///////////////////////// ConcurrentFreeList::acquire ///////////////////////
+inline void *ConcurrentFreeList::acquire(std::size_t bytes, std::size_t alignment)
+{
+  auto result = m_local.acquire(bytes, alignment);
+
+  if (!result && m_returned.load(std::memory_order_relaxed) != nullptr)
+  {
+    reclaim();
+
+    result = m_local.acquire(bytes, alignment);
+  }
+
+  return result;
+}
+
+
+///////////////////////// ConcurrentFreeList::push //////////////////////////
+inline void ConcurrentFreeList::push(void *first, void *last) noexcept
+{
+  auto node = FreeList::node_cast<FreeList::Node>(last);
+
+  node->next = m_returned.load(std::memory_order_relaxed);
+
+  while (!m_returned.compare_exchange_weak(node->next, first, std::memory_order_release, std::memory_order_relaxed))
+    ;
+}
+
+
+///////////////////////// ConcurrentFreeList::release ///////////////////////
+inline void ConcurrentFreeList::release(void *ptr, std::size_t bytes) noexcept
+{
+  if (thread_index() == m_owner)
+  {
+    m_local.release(ptr, bytes);
+
+    return;
+  }
+
+  auto node = FreeList::node_cast<FreeList::Node>(ptr);
+
+  if ((char*)node + sizeof(FreeList::Node) <= (char*)ptr + bytes)
+  {
+    node->bytes = bytes;
+
+    push(ptr, ptr);
+  }
+}
+
+
+///////////////////////// ConcurrentFreeList::release ///////////////////////
+inline void ConcurrentFreeList::release(FreeList &cache) noexcept
+{
+  for(size_t index = 0; index < FreeList::Buckets; ++index)
   {
-    if (other->m_freelist[index] != nullptr)
+    if (cache.m_head[index] != nullptr)
     {
-      auto entry = other->m_freelist[index];
-      auto node = node_cast<Node>(entry);
-
-      while (node->next != nullptr)
-      {
-        entry = node->next;
-        node = node_cast<Node>(entry);
-      }
-
-      node->next = m_freelist[index];
-      m_freelist[index] = other->m_freelist[index];
-      other->m_freelist[index] = nullptr;
+      push(cache.m_head[index], cache.m_tail[index]);
+
+      cache.m_head[index] = nullptr;
+      cache.m_tail[index] = nullptr;
     }
   }
 }
 
 
+///////////////////////// ConcurrentFreeList::reclaim ///////////////////////
+inline void ConcurrentFreeList::reclaim()
+{
+  auto entry = m_returned.exchange(nullptr, std::memory_order_acquire);
+
+  while (entry != nullptr)
+  {
+    auto node = FreeList::node_cast<FreeList::Node>(entry);
+
+    auto next = node->next;
+
+    m_local.release(entry, node->bytes);
+
+    entry = next;
+  }
+}
+
+
 
 //|---------------------- StackAllocatorWithFreelist ------------------------
 //|--------------------------------------------------------------------------
@@ -251,15 +693,21 @@ class StackAllocatorWithFreelist : public StackAllocator<T>
   public:
 
     StackAllocatorWithFreelist(Arena &arena, FreeList &freelist) noexcept;
+    StackAllocatorWithFreelist(Arena &arena, ConcurrentFreeList &freelist) noexcept;
 
     template<typename U>
     StackAllocatorWithFreelist(StackAllocator<U> const &other, FreeList &freelist) noexcept;
 
+    template<typename U>
+    StackAllocatorWithFreelist(StackAllocator<U> const &other, ConcurrentFreeList &freelist) noexcept;
+
     template<typename U>
     StackAllocatorWithFreelist(StackAllocatorWithFreelist<U> const &other) noexcept;
 
     FreeList &freelist() const { return *m_freelist; }
 
+    ConcurrentFreeList *concurrentfreelist() const { return m_concurrentfreelist; }
+
     T *allocate(std::size_t n, std::size_t alignment = alignof(T));
 
     void deallocate(T *ptr, std::size_t n) noexcept;
@@ -267,6 +715,7 @@ class StackAllocatorWithFreelist : public StackAllocator<T>
   private:
 
     FreeList *m_freelist;
+    ConcurrentFreeList *m_concurrentfreelist;
 };
 
 
@@ -276,6 +725,17 @@ StackAllocatorWithFreelist<T>::StackAllocatorWithFreelist(Arena &arena, FreeList
   : StackAllocator<T>(arena)
 {
   m_freelist = &freelist;
+  m_concurrentfreelist = nullptr;
+}
+
+
+///////////////////////// StackAllocatorWithFreelist::Constructor ///////////
+template<typename T>
+StackAllocatorWithFreelist<T>::StackAllocatorWithFreelist(Arena &arena, ConcurrentFreeList &freelist) noexcept
+  : StackAllocator<T>(arena)
+{
+  m_freelist = &freelist.local();
+  m_concurrentfreelist = &freelist;
 }
 
 
@@ -288,12 +748,23 @@ StackAllocatorWithFreelist<T>::StackAllocatorWithFreelist(StackAllocator<U> cons
 }
 
 
+///////////////////////// StackAllocatorWithFreelist::Constructor ///////////
+template<typename T>
+template<typename U>
+StackAllocatorWithFreelist<T>::StackAllocatorWithFreelist(StackAllocator<U> const &other, ConcurrentFreeList &freelist) noexcept
+  : StackAllocatorWithFreelist(other.arena(), freelist)
+{
+}
+
+
 ///////////////////////// StackAllocatorWithFreelist::rebind ////////////////
 template<typename T>
 template<typename U>
 StackAllocatorWithFreelist<T>::StackAllocatorWithFreelist(StackAllocatorWithFreelist<U> const &other) noexcept
-  : StackAllocatorWithFreelist(other.arena(), other.freelist())
+  : StackAllocator<T>(other.arena())
 {
+  m_freelist = &other.freelist();
+  m_concurrentfreelist = other.concurrentfreelist();
 }
 
 
@@ -303,7 +774,16 @@ T *StackAllocatorWithFreelist<T>::allocate(std::size_t n, std::size_t alignment)
 {
   auto mask = FreeList::bucket_mask(n*sizeof(T));
 
-  auto result = m_freelist->acquire((n*sizeof(T) + mask) & ~mask, alignment);
+  // a concurrent list reclaims blocks released by other threads on a miss
+
+  auto result = m_concurrentfreelist ? m_concurrentfreelist->acquire((n*sizeof(T) + mask) & ~mask, alignment) : m_freelist->acquire((n*sizeof(T) + mask) & ~mask, alignment);
+
+#ifdef ALLOCATION_TRACKING
+  if (result)
+    track_freelist_hit(result, (n*sizeof(T) + mask) & ~mask);
+  else
+    track_freelist_miss(this->arena());
+#endif
 
   if (!result)
   {
@@ -320,7 +800,14 @@ void StackAllocatorWithFreelist<T>::deallocate(T *ptr, std::size_t n) noexcept
 {
   auto mask = FreeList::bucket_mask(n*sizeof(T));
 
-  m_freelist->release(ptr, (n*sizeof(T) + mask) & ~mask);
+#ifdef ALLOCATION_TRACKING
+  track_release(ptr, (n*sizeof(T) + mask) & ~mask);
+#endif
+
+  if (m_concurrentfreelist)
+    m_concurrentfreelist->release(ptr, (n*sizeof(T) + mask) & ~mask);
+  else
+    m_freelist->release(ptr, (n*sizeof(T) + mask) & ~mask);
 }
 
 
@@ -375,10 +862,38 @@ inline void deallocate(FreeList *freelist, void *ptr, std::size_t bytes)
   {
     auto mask = FreeList::bucket_mask(bytes);
 
+#ifdef ALLOCATION_TRACKING
+    track_release(ptr, (bytes + mask) & ~mask);
+#endif
+
     freelist->release(ptr, (bytes + mask) & ~mask);
   }
 }
 
+inline void deallocate(ConcurrentFreeList *freelist, void *ptr, std::size_t bytes)
+{
+  if (ptr)
+  {
+    auto mask = FreeList::bucket_mask(bytes);
+
+#ifdef ALLOCATION_TRACKING
+    track_release(ptr, (bytes + mask) & ~mask);
+#endif
+
+    freelist->release(ptr, (bytes + mask) & ~mask);
+  }
+}
+
+
+///////////////////////// coalesce //////////////////////////////////////////
+inline void coalesce(StackAllocatorWithFreelist<> const &allocator)
+{
+  if (allocator.concurrentfreelist())
+    allocator.concurrentfreelist()->reclaim();
+
+  allocator.freelist().coalesce(allocator.arena());
+}
+
 
 ///////////////////////// allocate //////////////////////////////////////////
 inline Arena allocate(StackAllocator<> const &allocator, std::size_t slabsize)
@@ -406,3 +921,138 @@ inline void rewind(Arena &arena, size_t mark)
   arena.size = mark;
 }
 
+
+
+//|---------------------- ScratchScope --------------------------------------
+//|--------------------------------------------------------------------------
+
+class ScratchScope
+{
+  public:
+
+    explicit ScratchScope(Arena &arena) noexcept
+      : m_arena(&arena), m_mark(mark(arena))
+    {
+    }
+
+    ScratchScope(ScratchScope const &) = delete;
+    ScratchScope &operator=(ScratchScope const &) = delete;
+
+    ~ScratchScope()
+    {
+      rewind(*m_arena, m_mark);
+    }
+
+    Arena &arena() const { return *m_arena; }
+
+    operator StackAllocator<>() const { return *m_arena; }
+
+  private:
+
+    Arena *m_arena;
+
+    size_t m_mark;
+};
+
+
+
+//|---------------------- ThreadArenas --------------------------------------
+//|--------------------------------------------------------------------------
+
+// Per-thread scratch arenas indexed by thread_index(), one slab per thread
+// carved up front so that worker threads never touch the (unsynchronised)
+// parent arena. Size for the job system with PlatformInterface::work_threads.
+
+class ThreadArenas
+{
+  public:
+
+    ThreadArenas() = default;
+    ThreadArenas(StackAllocator<> const &allocator, std::size_t slabsize, std::size_t threads);
+
+    ThreadArenas(ThreadArenas const &) = delete;
+    ThreadArenas &operator=(ThreadArenas const &) = delete;
+
+    Arena &local();
+
+  private:
+
+    size_t m_count = 0;
+    Arena *m_arenas = nullptr;
+};
+
+
+///////////////////////// ThreadArenas::Constructor /////////////////////////
+inline ThreadArenas::ThreadArenas(StackAllocator<> const &allocator, std::size_t slabsize, std::size_t threads)
+{
+  m_arenas = allocate<Arena>(allocator, threads);
+
+  auto region = allocate(allocator, slabsize * threads);
+
+  for(size_t i = 0; i < threads; ++i)
+  {
+    m_arenas[i].size = 0;
+    m_arenas[i].capacity = slabsize;
+    m_arenas[i].data = static_cast<char*>(region.data) + i * slabsize;
+  }
+
+  m_count = threads;
+}
+
+
+///////////////////////// ThreadArenas::local ///////////////////////////////
+inline Arena &ThreadArenas::local()
+{
+  auto index = thread_index();
+
+  if (index >= m_count)
+    throw std::bad_alloc();
+
+  return m_arenas[index];
+}
+
+
+
+//|---------------------- FrameArena ----------------------------------------
+//|--------------------------------------------------------------------------
+
+// Double buffered arena, allocations remain valid until the end of the
+// following frame. flip() at the frame boundary resets the oldest slab.
+
+class FrameArena
+{
+  public:
+
+    FrameArena() = default;
+    FrameArena(StackAllocator<> const &allocator, std::size_t slabsize);
+
+    FrameArena(FrameArena const &) = delete;
+    FrameArena &operator=(FrameArena const &) = delete;
+
+    Arena &current() { return m_arenas[m_frame & 1]; }
+    Arena &previous() { return m_arenas[(m_frame + 1) & 1]; }
+
+    void flip();
+
+  private:
+
+    size_t m_frame = 0;
+    Arena m_arenas[2] = {};
+};
+
+
+///////////////////////// FrameArena::Constructor ///////////////////////////
+inline FrameArena::FrameArena(StackAllocator<> const &allocator, std::size_t slabsize)
+{
+  m_arenas[0] = allocate(allocator, slabsize);
+  m_arenas[1] = allocate(allocator, slabsize);
+}
+
+
+///////////////////////// FrameArena::flip //////////////////////////////////
+inline void FrameArena::flip()
+{
+  m_frame += 1;
+
+  m_arenas[m_frame & 1].size = 0;
+}
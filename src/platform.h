@@ -9,6 +9,7 @@
 #pragma once
 
 #include <cstddef>
+#include <atomic>
 #include <vulkan/vulkan.h>
 
 namespace DatumPlatform
@@ -149,6 +150,19 @@ namespace DatumPlatform
     };
 
 
+    //|---------------------- WorkCounter ---------------------------------------
+    //|--------------------------------------------------------------------------
+
+    struct WorkCounter
+    {
+      WorkCounter() : pending(0), waiters(nullptr) { }
+
+      std::atomic<int> pending;
+
+      void *waiters; // platform owned
+    };
+
+
     //|---------------------- PlatformInterface ---------------------------------
     //|--------------------------------------------------------------------------
 
@@ -168,6 +182,11 @@ namespace DatumPlatform
 
       virtual handle_t open_handle(const char *identifier) = 0;
       virtual std::size_t read_handle(handle_t handle, uint64_t position, void *buffer, std::size_t bytes) = 0;
+
+      // callback(platform, userdata, bytesread) is run on the work queue once
+      // the read completes, bytesread is short on error or end of file
+
+      virtual void read_handle_async(handle_t handle, uint64_t position, void *buffer, std::size_t bytes, void (*callback)(PlatformInterface &, void*, std::size_t), void *userdata) = 0;
       virtual void close_handle(handle_t handle) = 0;
 
       // cursor
@@ -184,6 +203,19 @@ namespace DatumPlatform
 
       virtual void submit_work(void (*func)(PlatformInterface &, void*, void*), void *ldata, void *rdata) = 0;
 
+      // counter is incremented on submit and decremented on completion, the
+      // work is held back until dependency (if not null) reaches zero
+
+      virtual void submit_work(void (*func)(PlatformInterface &, void*, void*), void *ldata, void *rdata, WorkCounter *counter, WorkCounter *dependency) = 0;
+
+      // runs pending work on the calling thread until counter reaches zero
+
+      virtual void wait_work(WorkCounter *counter) = 0;
+
+      // bound on thread_index() of any thread that runs or submits work
+
+      virtual std::size_t work_threads() = 0;
+
       // misc
 
       virtual void terminate() = 0;
@@ -48,10 +48,57 @@ struct FoilageSet
   alignas(16) Transform modelworlds[1];
 };
 
+struct CasterList::Packet
+{
+  enum Type
+  {
+    Model,
+    Actor,
+    Foilage,
+  };
+
+  uint64_t key;
+
+  Type type;
+
+  Mesh const *mesh;
+  Material const *material;
+
+  uint32_t instancecount;
+  uint32_t cascades;
+
+  VkDescriptorSet materialset;
+  uint32_t materialsetoffset;
+
+  VkDescriptorSet modelset;
+  uint32_t modelsetoffset;
+
+  Packet *next;
+};
+
+extern void shadow_cascades(ShadowMap const &shadowmap, Camera const &camera, Vec3 const &lightdirection, float *cascadesplits, Matrix4f *cascadeviews, Frustum *cascadefrustums);
+
+///////////////////////// cascade_mask //////////////////////////////////////
+uint32_t cascade_mask(CasterList::BuildState const &state, Bound3 const &bound)
+{
+  if (!state.cullcascades)
+    return (1 << ShadowMap::nslices) - 1;
+
+  uint32_t mask = 0;
+
+  for(int i = 0; i < ShadowMap::nslices; ++i)
+  {
+    if (intersects(state.cascadefrustums[i], bound))
+      mask |= 1 << i;
+  }
+
+  return mask;
+}
+
 ///////////////////////// draw_casters //////////////////////////////////////
 void draw_casters(RenderContext &context, VkCommandBuffer commandbuffer, Renderable::Casters const &casters)
 {
-  execute(commandbuffer, casters.castercommands);
+  execute(commandbuffer, casters.castercommands, casters.sublistcount);
 }
 
 
@@ -59,13 +106,14 @@ void draw_casters(RenderContext &context, VkCommandBuffer commandbuffer, Rendera
 //|--------------------------------------------------------------------------
 
 ///////////////////////// CasterList::begin /////////////////////////////////
-bool CasterList::begin(BuildState &state, RenderContext &context, ResourceManager &resources)
+bool CasterList::begin(BuildState &state, RenderContext &context, ResourceManager &resources, StackAllocator<> const &scratch)
 {
   m_commandlump = {};
 
   state = {};
   state.context = &context;
   state.resources = &resources;
+  state.scratch = &scratch.arena();
 
   if (!context.ready)
     return false;
@@ -97,6 +145,48 @@ bool CasterList::begin(BuildState &state, RenderContext &context, ResourceManage
 }
 
 
+///////////////////////// CasterList::begin /////////////////////////////////
+bool CasterList::begin(BuildState &state, RenderContext &context, ResourceManager &resources, StackAllocator<> const &scratch, Camera const &camera, Vec3 const &lightdirection)
+{
+  if (!begin(state, context, resources, scratch))
+    return false;
+
+  // cascades match those calculated by render() for the same camera & light
+
+  shadow_cascades(context.shadows, camera, lightdirection, nullptr, nullptr, state.cascadefrustums);
+
+  state.cullcascades = true;
+
+  return true;
+}
+
+
+///////////////////////// CasterList::push_packet ///////////////////////////
+CasterList::Packet *CasterList::push_packet(BuildState &state, int type, Mesh const *mesh, Material const *material)
+{
+  auto packet = acquire_record<Packet>(*state.scratch);
+
+  if (packet)
+  {
+    packet->key = packet_sortkey(type, material, mesh);
+    packet->type = static_cast<Packet::Type>(type);
+    packet->mesh = mesh;
+    packet->material = material;
+    packet->instancecount = 0;
+    packet->cascades = 0;
+    packet->materialset = VK_NULL_HANDLE;
+    packet->materialsetoffset = 0;
+    packet->modelset = VK_NULL_HANDLE;
+    packet->modelsetoffset = 0;
+    packet->next = state.packets;
+
+    state.packets = packet;
+  }
+
+  return packet;
+}
+
+
 ///////////////////////// CasterList::push_mesh /////////////////////////////
 void CasterList::push_mesh(BuildState &state, Transform const &transform, Mesh const *mesh, Material const *material)
 {
@@ -107,52 +197,44 @@ void CasterList::push_mesh(BuildState &state, Transform const &transform, Mesh c
   auto &context = *state.context;
   auto &commandlump = *state.commandlump;
 
-  if (state.pipeline != context.modelshadowpipeline)
-  {
-    bind_pipeline(castercommands, context.modelshadowpipeline, 0, 0, context.shadows.width, context.shadows.height, VK_PIPELINE_BIND_POINT_GRAPHICS);
+  auto cascades = cascade_mask(state, transform * mesh->bound);
 
-    state.pipeline = context.modelshadowpipeline;
-  }
+  if (cascades == 0)
+    return;
 
-  if (state.mesh != mesh)
+  if (state.modelset.available() < sizeof(ModelSet))
   {
-    bind_vertexbuffer(castercommands, 0, mesh->vertexbuffer);
-
-    state.mesh = mesh;
+    state.modelset = commandlump.acquire_descriptor(context.modelsetlayout, sizeof(ModelSet), std::move(state.modelset));
   }
 
-  if (state.material != material)
+  if (state.modelset)
   {
-    state.materialset = commandlump.acquire_descriptor(context.materialsetlayout, sizeof(MaterialSet), std::move(state.materialset));
+    auto packet = push_packet(state, Packet::Model, mesh, material);
 
-    if (state.materialset)
-    {
-      auto offset = state.materialset.reserve(sizeof(MaterialSet));
-
-      bind_texture(context.vulkan, state.materialset, ShaderLocation::albedomap, material->albedomap ? material->albedomap->texture : context.whitediffuse);
+    Packet direct = {};
 
-      bind_descriptor(castercommands, context.pipelinelayout, ShaderLocation::materialset, state.materialset, offset, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    if (!packet)
+    {
+      direct.type = Packet::Model;
+      direct.mesh = mesh;
+      direct.material = material;
 
-      state.material = material;
+      packet = &direct;
     }
-  }
 
-  if (state.modelset.available() < sizeof(ModelSet))
-  {
-    state.modelset = commandlump.acquire_descriptor(context.modelsetlayout, sizeof(ModelSet), std::move(state.modelset));
-  }
-
-  if (state.modelset && state.materialset)
-  {
     auto offset = state.modelset.reserve(sizeof(ModelSet));
 
     auto modelset = state.modelset.memory<ModelSet>(offset);
 
     modelset->modelworld = transform;
 
-    bind_descriptor(castercommands, context.pipelinelayout, ShaderLocation::modelset, state.modelset, offset, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    packet->instancecount = 1;
+    packet->cascades = cascades;
+    packet->modelset = state.modelset;
+    packet->modelsetoffset = offset;
 
-    draw(castercommands, mesh->vertexbuffer.indexcount, 1, 0, 0, 0);
+    if (packet == &direct)
+      draw_direct(state, direct);
   }
 }
 
@@ -167,35 +249,38 @@ void CasterList::push_mesh(BuildState &state, Transform const &transform, Pose c
   auto &context = *state.context;
   auto &commandlump = *state.commandlump;
 
-  if (state.pipeline != context.actorshadowpipeline)
-  {
-    bind_pipeline(castercommands, context.actorshadowpipeline, 0, 0, context.shadows.width, context.shadows.height, VK_PIPELINE_BIND_POINT_GRAPHICS);
+  auto cascades = cascade_mask(state, transform * mesh->bound);
 
-    state.pipeline = context.actorshadowpipeline;
-  }
+  if (cascades == 0)
+    return;
 
-  if (state.mesh != mesh)
-  {
-    bind_vertexbuffer(castercommands, 0, mesh->vertexbuffer);
-    bind_vertexbuffer(castercommands, 1, mesh->rigbuffer);
+  VkDescriptorSet cachedset;
+  VkDeviceSize cachedoffset;
 
-    state.mesh = mesh;
-  }
-
-  if (state.material != material)
+  if (state.posecache && state.posecache->lookup(commandlump, &pose, transform, &cachedset, &cachedoffset))
   {
-    state.materialset = commandlump.acquire_descriptor(context.materialsetlayout, sizeof(MaterialSet), std::move(state.materialset));
+    auto packet = push_packet(state, Packet::Actor, mesh, material);
 
-    if (state.materialset)
+    Packet direct = {};
+
+    if (!packet)
     {
-      auto offset = state.materialset.reserve(sizeof(MaterialSet));
+      direct.type = Packet::Actor;
+      direct.mesh = mesh;
+      direct.material = material;
 
-      bind_texture(context.vulkan, state.materialset, ShaderLocation::albedomap, material->albedomap ? material->albedomap->texture : context.whitediffuse);
+      packet = &direct;
+    }
 
-      bind_descriptor(castercommands, context.pipelinelayout, ShaderLocation::materialset, state.materialset, offset, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    packet->instancecount = 1;
+    packet->cascades = cascades;
+    packet->modelset = cachedset;
+    packet->modelsetoffset = cachedoffset;
 
-      state.material = material;
-    }
+    if (packet == &direct)
+      draw_direct(state, direct);
+
+    return;
   }
 
   size_t actorsetsize = sizeof(ActorSet) + (pose.bonecount-1)*sizeof(Transform);
@@ -205,8 +290,21 @@ void CasterList::push_mesh(BuildState &state, Transform const &transform, Pose c
     state.modelset = commandlump.acquire_descriptor(context.modelsetlayout, actorsetsize, std::move(state.modelset));
   }
 
-  if (state.modelset && state.materialset)
+  if (state.modelset)
   {
+    auto packet = push_packet(state, Packet::Actor, mesh, material);
+
+    Packet direct = {};
+
+    if (!packet)
+    {
+      direct.type = Packet::Actor;
+      direct.mesh = mesh;
+      direct.material = material;
+
+      packet = &direct;
+    }
+
     auto offset = state.modelset.reserve(actorsetsize);
 
     auto modelset = state.modelset.memory<ActorSet>(offset);
@@ -215,9 +313,18 @@ void CasterList::push_mesh(BuildState &state, Transform const &transform, Pose c
 
     copy(pose.bones, pose.bones + pose.bonecount, modelset->bones);
 
-    bind_descriptor(castercommands, context.pipelinelayout, ShaderLocation::modelset, state.modelset, offset, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    if (state.posecache)
+    {
+      state.posecache->insert(state.modelset, offset, &pose, transform);
+    }
+
+    packet->instancecount = 1;
+    packet->cascades = cascades;
+    packet->modelset = state.modelset;
+    packet->modelsetoffset = offset;
 
-    draw(castercommands, mesh->vertexbuffer.indexcount, 1, 0, 0, 0);
+    if (packet == &direct)
+      draw_direct(state, direct);
   }
 }
 
@@ -232,35 +339,15 @@ void CasterList::push_foilage(BuildState &state, Transform const *transforms, si
   auto &context = *state.context;
   auto &commandlump = *state.commandlump;
 
-  if (state.pipeline != context.foilageshadowpipeline)
-  {
-    bind_pipeline(castercommands, context.foilageshadowpipeline, 0, 0, context.shadows.width, context.shadows.height, VK_PIPELINE_BIND_POINT_GRAPHICS);
-
-    state.pipeline = context.foilageshadowpipeline;
-  }
+  uint32_t cascades = 0;
 
-  if (state.mesh != mesh)
+  for(size_t i = 0; i < count; ++i)
   {
-    bind_vertexbuffer(castercommands, 0, mesh->vertexbuffer);
-
-    state.mesh = mesh;
+    cascades |= cascade_mask(state, transforms[i] * mesh->bound);
   }
 
-  if (state.material != material)
-  {
-    state.materialset = commandlump.acquire_descriptor(context.materialsetlayout, sizeof(MaterialSet), std::move(state.materialset));
-
-    if (state.materialset)
-    {
-      auto offset = state.materialset.reserve(sizeof(MaterialSet));
-
-      bind_texture(context.vulkan, state.materialset, ShaderLocation::albedomap, material->albedomap ? material->albedomap->texture : context.whitediffuse);
-
-      bind_descriptor(castercommands, context.pipelinelayout, ShaderLocation::materialset, state.materialset, offset, VK_PIPELINE_BIND_POINT_GRAPHICS);
-
-      state.material = material;
-    }
-  }
+  if (cascades == 0)
+    return;
 
   size_t foilagesetsize = sizeof(FoilageSet) + (count-1)*sizeof(Transform);
 
@@ -269,8 +356,21 @@ void CasterList::push_foilage(BuildState &state, Transform const *transforms, si
     state.modelset = commandlump.acquire_descriptor(context.modelsetlayout, foilagesetsize, std::move(state.modelset));
   }
 
-  if (state.modelset && state.materialset)
+  if (state.modelset)
   {
+    auto packet = push_packet(state, Packet::Foilage, mesh, material);
+
+    Packet direct = {};
+
+    if (!packet)
+    {
+      direct.type = Packet::Foilage;
+      direct.mesh = mesh;
+      direct.material = material;
+
+      packet = &direct;
+    }
+
     auto offset = state.modelset.reserve(foilagesetsize);
 
     auto modelset = state.modelset.memory<FoilageSet>(offset);
@@ -284,13 +384,169 @@ void CasterList::push_foilage(BuildState &state, Transform const *transforms, si
       modelset->modelworlds[i] = transforms[i];
     }
 
-    bind_descriptor(castercommands, context.pipelinelayout, ShaderLocation::modelset, state.modelset, offset, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    packet->instancecount = count;
+    packet->cascades = cascades;
+    packet->modelset = state.modelset;
+    packet->modelsetoffset = offset;
 
-    draw(castercommands, mesh->vertexbuffer.indexcount, count, 0, 0, 0);
+    if (packet == &direct)
+      draw_direct(state, direct);
   }
 }
 
 
+///////////////////////// CasterList::flush_packets /////////////////////////
+void CasterList::flush_packets(BuildState &state)
+{
+  assert(state.commandlump);
+
+  auto &context = *state.context;
+  auto &commandlump = *state.commandlump;
+
+  auto packets = sort_packets(state.packets, *state.scratch);
+
+  // material sets are written once up front and shared by every cascade,
+  // materials with the same albedo map share a set
+
+  for(Packet *packet = packets, *prev = nullptr; packet; prev = packet, packet = packet->next)
+  {
+    auto &material = packet->material;
+
+    if (prev && prev->material == material)
+    {
+      packet->materialset = prev->materialset;
+      packet->materialsetoffset = prev->materialsetoffset;
+      continue;
+    }
+
+    if (!state.materialset || state.materialset.available() < sizeof(MaterialSet) || !state.material || state.material->albedomap != material->albedomap)
+    {
+      state.materialset = commandlump.acquire_descriptor(context.materialsetlayout, sizeof(MaterialSet), std::move(state.materialset));
+
+      if (state.materialset)
+      {
+        bind_texture(context.vulkan, state.materialset, ShaderLocation::albedomap, material->albedomap ? material->albedomap->texture : context.whitediffuse);
+      }
+    }
+
+    if (state.materialset)
+    {
+      packet->materialset = state.materialset;
+      packet->materialsetoffset = state.materialset.reserve(sizeof(MaterialSet));
+    }
+
+    state.material = material;
+  }
+
+  state.material = nullptr;
+
+  // each cascade is drawn as its own command range, restricted to the casters overlapping it
+
+  for(uint32_t cascade = 0; cascade < ShadowMap::nslices; ++cascade)
+  {
+    push(castercommands, context.pipelinelayout, 0, sizeof(cascade), &cascade, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_GEOMETRY_BIT);
+
+    for(Packet const *packet = packets; packet; packet = packet->next)
+    {
+      if (!(packet->cascades & (1 << cascade)))
+        continue;
+
+      auto &mesh = packet->mesh;
+      auto &material = packet->material;
+
+      switch (packet->type)
+      {
+        case Packet::Model:
+          if (state.pipeline != context.modelshadowpipeline)
+          {
+            bind_pipeline(castercommands, context.modelshadowpipeline, 0, 0, context.shadows.width, context.shadows.height, VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+            state.pipeline = context.modelshadowpipeline;
+            state.mesh = nullptr;
+          }
+
+          if (state.mesh != mesh)
+          {
+            bind_vertexbuffer(castercommands, 0, mesh->vertexbuffer);
+
+            state.mesh = mesh;
+          }
+          break;
+
+        case Packet::Actor:
+          if (state.pipeline != context.actorshadowpipeline)
+          {
+            bind_pipeline(castercommands, context.actorshadowpipeline, 0, 0, context.shadows.width, context.shadows.height, VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+            state.pipeline = context.actorshadowpipeline;
+            state.mesh = nullptr;
+          }
+
+          if (state.mesh != mesh)
+          {
+            bind_vertexbuffer(castercommands, 0, mesh->vertexbuffer);
+            bind_vertexbuffer(castercommands, 1, mesh->rigbuffer);
+
+            state.mesh = mesh;
+          }
+          break;
+
+        case Packet::Foilage:
+          if (state.pipeline != context.foilageshadowpipeline)
+          {
+            bind_pipeline(castercommands, context.foilageshadowpipeline, 0, 0, context.shadows.width, context.shadows.height, VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+            state.pipeline = context.foilageshadowpipeline;
+            state.mesh = nullptr;
+          }
+
+          if (state.mesh != mesh)
+          {
+            bind_vertexbuffer(castercommands, 0, mesh->vertexbuffer);
+
+            state.mesh = mesh;
+          }
+          break;
+      }
+
+      if (!packet->materialset)
+        continue;
+
+      if (state.material != material)
+      {
+        bind_descriptor(castercommands, context.pipelinelayout, ShaderLocation::materialset, packet->materialset, packet->materialsetoffset, VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+        state.material = material;
+      }
+
+      bind_descriptor(castercommands, context.pipelinelayout, ShaderLocation::modelset, packet->modelset, packet->modelsetoffset, VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+      draw(castercommands, mesh->vertexbuffer.indexcount, packet->instancecount, 0, 0, 0);
+    }
+  }
+
+  state.packets = nullptr;
+}
+
+
+///////////////////////// CasterList::draw_direct ///////////////////////////
+void CasterList::draw_direct(BuildState &state, Packet &packet)
+{
+  // host scratch is exhausted, so rather than drop the caster, flush what is
+  // pending and record this packet on its own
+
+  LOG_ONCE("Caster Scratch Exhausted");
+
+  flush_packets(state);
+
+  packet.next = nullptr;
+
+  state.packets = &packet;
+
+  flush_packets(state);
+}
+
+
 ///////////////////////// CasterList::finalise //////////////////////////////
 void CasterList::finalise(BuildState &state)
 {
@@ -298,6 +554,8 @@ void CasterList::finalise(BuildState &state)
 
   auto &context = *state.context;
 
+  flush_packets(state);
+
   end(context.vulkan, castercommands);
 
   state.commandlump = nullptr;
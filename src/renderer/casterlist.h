@@ -29,6 +29,8 @@ class CasterList
 
   public:
 
+    struct Packet;
+
     struct BuildState
     {
       RenderContext *context;
@@ -42,11 +44,22 @@ class CasterList
 
       CommandLump *commandlump = nullptr;
 
+      Arena *scratch = nullptr;
+
+      PoseCache *posecache = nullptr;
+
       Mesh const *mesh;
       Material const *material;
+
+      Packet *packets;
+
+      bool cullcascades;
+      lml::Frustum cascadefrustums[ShadowMap::nslices];
     };
 
-    bool begin(BuildState &state, RenderContext &context, ResourceManager &resources);
+    // packet records are built in host scratch memory
+    bool begin(BuildState &state, RenderContext &context, ResourceManager &resources, StackAllocator<> const &scratch);
+    bool begin(BuildState &state, RenderContext &context, ResourceManager &resources, StackAllocator<> const &scratch, Camera const &camera, lml::Vec3 const &lightdirection);
 
     void push_mesh(BuildState &state, lml::Transform const &transform, Mesh const *mesh, Material const *material);
 
@@ -62,5 +75,11 @@ class CasterList
 
   private:
 
+    Packet *push_packet(BuildState &state, int type, Mesh const *mesh, Material const *material);
+
+    void flush_packets(BuildState &state);
+
+    void draw_direct(BuildState &state, Packet &packet);
+
     unique_resource<CommandLump> m_commandlump;
 };
@@ -76,6 +76,7 @@ CommandLump::Descriptor CommandLump::acquire_descriptor(VkDeviceSize required, D
 
   if (m_resourcelump)
   {
+    swap(descriptor.m_base, oldset.m_base);
     swap(descriptor.m_used, oldset.m_used);
     swap(descriptor.m_storage, oldset.m_storage);
 
@@ -86,6 +87,8 @@ CommandLump::Descriptor CommandLump::acquire_descriptor(VkDeviceSize required, D
         context->resourcepool.release_storagebuffer(descriptor.m_storage, descriptor.m_used);
       }
 
+      descriptor.m_shared = false;
+      descriptor.m_base = 0;
       descriptor.m_used = 0;
       descriptor.m_storage = context->resourcepool.acquire_storagebuffer(m_resourcelump, required);
     }
@@ -115,15 +118,156 @@ CommandLump::Descriptor CommandLump::acquire_descriptor(VkDescriptorSetLayout la
 
   if (descriptor.m_storage)
   {
-    descriptor.m_descriptor = context->resourcepool.acquire_descriptorset(m_resourcelump, layout);
+    if (auto dynamicset = context->resourcepool.acquire_dynamicset(layout))
+    {
+      descriptor.m_shared = true;
+      descriptor.m_base = descriptor.m_storage.offset;
+      descriptor.m_descriptor = dynamicset;
+    }
+    else
+    {
+      descriptor.m_shared = false;
+      descriptor.m_base = 0;
+      descriptor.m_descriptor = context->resourcepool.acquire_descriptorset(m_resourcelump, layout);
 
-    bind_buffer(context->vulkan, descriptor.m_descriptor, 0, descriptor.m_storage, descriptor.m_storage.offset, descriptor.m_storage.capacity, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC);
+      bind_buffer(context->vulkan, descriptor.m_descriptor, 0, descriptor.m_storage, descriptor.m_storage.offset, descriptor.m_storage.capacity, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC);
+    }
   }
 
   return descriptor;
 }
 
 
+///////////////////////// CommandLump::retain ///////////////////////////////
+bool CommandLump::retain(ResourcePool::StorageBuffer const &storage)
+{
+  assert(context);
+
+  if (!m_resourcelump)
+    return false;
+
+  return context->resourcepool.retain_storagebuffer(m_resourcelump, storage);
+}
+
+
+//|---------------------- PoseCache -----------------------------------------
+//|--------------------------------------------------------------------------
+
+namespace
+{
+  size_t pose_bucket(Pose const *pose)
+  {
+    return (reinterpret_cast<uintptr_t>(pose) >> 4) % PoseCache::EntrySlots;
+  }
+}
+
+///////////////////////// PoseCache::Constructor ////////////////////////////
+PoseCache::PoseCache(RenderContext *context)
+  : context(context)
+{
+  m_count = 0;
+  m_resourcelump = nullptr;
+
+  for(auto &entry : m_entries)
+    entry.pose = nullptr;
+}
+
+
+///////////////////////// PoseCache::Destructor /////////////////////////////
+PoseCache::~PoseCache()
+{
+  reset();
+}
+
+
+///////////////////////// PoseCache::reset //////////////////////////////////
+void PoseCache::reset()
+{
+  while (m_lock.test_and_set(std::memory_order_acquire))
+    ;
+
+  if (m_resourcelump)
+  {
+    context->resourcepool.release_lump(m_resourcelump);
+
+    m_resourcelump = nullptr;
+  }
+
+  for(auto &entry : m_entries)
+    entry.pose = nullptr;
+
+  m_count = 0;
+
+  m_lock.clear(std::memory_order_release);
+}
+
+
+///////////////////////// PoseCache::lookup /////////////////////////////////
+bool PoseCache::lookup(CommandLump &commandlump, Pose const *pose, lml::Transform const &transform, VkDescriptorSet *descriptor, VkDeviceSize *offset)
+{
+  bool result = false;
+
+  while (m_lock.test_and_set(std::memory_order_acquire))
+    ;
+
+  for(size_t i = pose_bucket(pose); m_entries[i].pose; i = (i + 1) % EntrySlots)
+  {
+    auto &entry = m_entries[i];
+
+    if (entry.pose == pose && memcmp(&entry.transform, &transform, sizeof(transform)) == 0)
+    {
+      if (commandlump.retain(entry.storage))
+      {
+        *descriptor = entry.descriptor;
+        *offset = entry.offset;
+
+        result = true;
+      }
+
+      break;
+    }
+  }
+
+  m_lock.clear(std::memory_order_release);
+
+  return result;
+}
+
+
+///////////////////////// PoseCache::insert /////////////////////////////////
+void PoseCache::insert(CommandLump::Descriptor const &descriptor, VkDeviceSize offset, Pose const *pose, lml::Transform const &transform)
+{
+  if (!descriptor.m_shared)
+    return;
+
+  while (m_lock.test_and_set(std::memory_order_acquire))
+    ;
+
+  if (!m_resourcelump)
+  {
+    m_resourcelump = context->resourcepool.acquire_lump();
+  }
+
+  if (m_resourcelump && m_count < EntrySlots/2 && context->resourcepool.retain_storagebuffer(m_resourcelump, descriptor.m_storage))
+  {
+    size_t i = pose_bucket(pose);
+
+    while (m_entries[i].pose)
+      i = (i + 1) % EntrySlots;
+
+    m_entries[i].pose = pose;
+    m_entries[i].transform = transform;
+    m_entries[i].descriptor = descriptor.m_descriptor.descriptorset;
+    m_entries[i].offset = offset;
+    m_entries[i].storage = descriptor.m_storage;
+
+    m_count += 1;
+  }
+
+  m_lock.clear(std::memory_order_release);
+}
+
+
 //|---------------------- CommandLump Resource ------------------------------
 //|--------------------------------------------------------------------------
 
@@ -9,10 +9,14 @@
 #pragma once
 
 #include "resourcepool.h"
+#include "datum/memory.h"
 #include <utility>
+#include <algorithm>
+#include <cmath>
 #include <cassert>
 
 struct RenderContext;
+class Pose;
 
 //|---------------------- CommandLump ---------------------------------------
 //|--------------------------------------------------------------------------
@@ -28,7 +32,7 @@ class CommandLump
         template<typename View>
         View *memory(VkDeviceSize offset = 0) const
         {
-          return (View*)((uint8_t*)m_storage.memory + offset);
+          return (View*)((uint8_t*)m_storage.memory + offset - m_base);
         }
 
         VkDeviceSize reserve(VkDeviceSize size)
@@ -39,7 +43,7 @@ class CommandLump
 
           m_used = (m_used + size + m_storage.alignment - 1) & -m_storage.alignment;
 
-          return offset;
+          return m_base + offset;
         }
 
         VkDeviceSize used() const { return m_used; }
@@ -52,6 +56,8 @@ class CommandLump
 
         Descriptor()
         {
+          m_shared = false;
+          m_base = 0;
           m_used = 0;
           m_pool = nullptr;
           m_storage = {};
@@ -76,6 +82,8 @@ class CommandLump
 
         Descriptor &operator=(Descriptor &&other) noexcept
         {
+          std::swap(m_shared, other.m_shared);
+          std::swap(m_base, other.m_base);
           std::swap(m_used, other.m_used);
           std::swap(m_pool, other.m_pool);
           std::swap(m_storage, other.m_storage);
@@ -86,6 +94,9 @@ class CommandLump
 
       private:
 
+        bool m_shared;
+
+        VkDeviceSize m_base;
         VkDeviceSize m_used;
 
         ResourcePool *m_pool;
@@ -93,6 +104,7 @@ class CommandLump
         ResourcePool::DescriptorSet m_descriptor;
 
         friend class CommandLump;
+        friend class PoseCache;
     };
 
   public:
@@ -108,9 +120,164 @@ class CommandLump
     Descriptor acquire_descriptor(VkDescriptorSetLayout layout, Descriptor &&oldset = {});
     Descriptor acquire_descriptor(VkDescriptorSetLayout layout, VkDeviceSize required, Descriptor &&oldset = {});
 
+    bool retain(ResourcePool::StorageBuffer const &storage);
+
+  private:
+
+    RenderContext *context;
+
+    ResourcePool::ResourceLump const *m_resourcelump;
+};
+
+
+//|---------------------- PoseCache -----------------------------------------
+//|--------------------------------------------------------------------------
+
+// Shares the uploaded actor set (model transform and bone palette) of a pose
+// between the lists built from it within a frame. Only storage bound through
+// a shared dynamic descriptor set can be reused, entries are dropped on reset
+
+class PoseCache
+{
+  public:
+
+    static constexpr int EntrySlots = 512;
+
+  public:
+    PoseCache(RenderContext *context);
+    PoseCache(PoseCache const &) = delete;
+    ~PoseCache();
+
+    void reset();
+
+    bool lookup(CommandLump &commandlump, Pose const *pose, lml::Transform const &transform, VkDescriptorSet *descriptor, VkDeviceSize *offset);
+
+    void insert(CommandLump::Descriptor const &descriptor, VkDeviceSize offset, Pose const *pose, lml::Transform const &transform);
+
   private:
 
+    struct Entry
+    {
+      Pose const *pose;
+      lml::Transform transform;
+
+      VkDescriptorSet descriptor;
+      VkDeviceSize offset;
+
+      ResourcePool::StorageBuffer storage;
+    };
+
     RenderContext *context;
 
+    size_t m_count;
+    Entry m_entries[EntrySlots];
+
     ResourcePool::ResourceLump const *m_resourcelump;
+
+    std::atomic_flag m_lock = ATOMIC_FLAG_INIT;
 };
+
+
+//|---------------------- Draw Packets --------------------------------------
+//|--------------------------------------------------------------------------
+
+// Sort Key : pipeline (8 bits) | material (24 bits) | mesh (24 bits) | depth (8 bits)
+//
+// depth is the view distance, log quantised, so draws sharing state go front
+// to back. It sits below the state bits, ordering never costs a rebind.
+
+///////////////////////// packet_sortkey ////////////////////////////////////
+inline uint64_t packet_sortkey(int pipeline, void const *material, void const *mesh, float depth = 0.0f)
+{
+  uint64_t materialid = (reinterpret_cast<uintptr_t>(material) >> 4) & 0xffffff;
+  uint64_t meshid = (reinterpret_cast<uintptr_t>(mesh) >> 4) & 0xffffff;
+  uint64_t depthid = (depth > 0.0f) ? std::min(uint64_t(std::log2(1.0f + depth) * 16.0f), uint64_t(0xff)) : 0;
+
+  return (uint64_t(pipeline) << 56) | (materialid << 32) | (meshid << 8) | depthid;
+}
+
+
+///////////////////////// sort_packets //////////////////////////////////////
+template<typename Packet>
+Packet *sort_packets(Packet *packets, Arena &scratch)
+{
+  // lsd radix sort of (key, packet) pairs in scratch, skipping bytes common
+  // to every key, then a single pass relinks the packets in key order
+
+  struct Entry
+  {
+    uint64_t key;
+    Packet *packet;
+  };
+
+  size_t count = 0;
+  uint64_t keyand = ~uint64_t(0);
+  uint64_t keyor = 0;
+
+  for(Packet const *packet = packets; packet; packet = packet->next)
+  {
+    keyand &= packet->key;
+    keyor |= packet->key;
+
+    count += 1;
+  }
+
+  if (count < 2)
+    return packets;
+
+  ScratchScope scope(scratch);
+
+  // without room for the pairs the packets are emitted unsorted
+
+  if (scratch.capacity - scratch.size < 2*count*sizeof(Entry) + alignof(Entry))
+    return packets;
+
+  auto entries = allocate<Entry>(scratch, 2*count);
+  auto sorted = entries + count;
+
+  size_t index = 0;
+
+  for(Packet *packet = packets; packet; packet = packet->next)
+  {
+    entries[index++] = { packet->key, packet };
+  }
+
+  for(int shift = 0; shift < 64; shift += 8)
+  {
+    if (((keyor ^ keyand) >> shift) & 0xff)
+    {
+      size_t offsets[256] = {};
+
+      for(size_t i = 0; i < count; ++i)
+        offsets[(entries[i].key >> shift) & 0xff] += 1;
+
+      for(size_t i = 0, sum = 0; i < 256; ++i)
+        sum += std::exchange(offsets[i], sum);
+
+      for(size_t i = 0; i < count; ++i)
+        sorted[offsets[(entries[i].key >> shift) & 0xff]++] = entries[i];
+
+      std::swap(entries, sorted);
+    }
+  }
+
+  for(size_t i = 1; i < count; ++i)
+  {
+    entries[i-1].packet->next = entries[i].packet;
+  }
+
+  entries[count-1].packet->next = nullptr;
+
+  return entries[0].packet;
+}
+
+
+///////////////////////// acquire_record ////////////////////////////////////
+template<typename T>
+T *acquire_record(Arena &scratch)
+{
+  if (scratch.capacity - scratch.size < sizeof(T) + alignof(T))
+    return nullptr;
+
+  return allocate<T>(scratch);
+}
@@ -61,6 +61,11 @@ struct ModelSet
   alignas(16) Transform modelworld;
 };
 
+struct InstanceSet
+{
+  alignas(16) Transform modelworlds[1];
+};
+
 struct ActorSet
 {
   alignas(16) Transform modelworld;
@@ -87,16 +92,51 @@ struct TerrainSet
   alignas( 4) uint32_t layers;
 };
 
+struct BatchInstance
+{
+  Transform transform;
+
+  BatchInstance *next;
+};
+
+struct GeometryList::Packet
+{
+  enum Type
+  {
+    Model,
+    Actor,
+    Foilage,
+  };
+
+  uint64_t key;
+
+  Type type;
+
+  Mesh const *mesh;
+  Material const *material;
+
+  uint32_t instancecount;
+  BatchInstance *instances;
+
+  VkDescriptorSet modelset;
+  uint32_t modelsetoffset;
+
+  Packet *chain;
+  Packet *next;
+};
+
+static constexpr size_t MaxBatchInstances = 1024;
+
 ///////////////////////// draw_prepass //////////////////////////////////////
 void draw_prepass(RenderContext &context, VkCommandBuffer commandbuffer, Renderable::Geometry const &geometry)
 {
-  execute(commandbuffer, geometry.prepasscommands);
+  execute(commandbuffer, geometry.prepasscommands, geometry.sublistcount);
 }
 
 ///////////////////////// draw_geometry /////////////////////////////////////
 void draw_geometry(RenderContext &context, VkCommandBuffer commandbuffer, Renderable::Geometry const &geometry)
 {
-  execute(commandbuffer, geometry.geometrycommands);
+  execute(commandbuffer, geometry.geometrycommands, geometry.sublistcount);
 }
 
 
@@ -104,13 +144,14 @@ void draw_geometry(RenderContext &context, VkCommandBuffer commandbuffer, Render
 //|--------------------------------------------------------------------------
 
 ///////////////////////// GeometryList::begin ///////////////////////////////
-bool GeometryList::begin(BuildState &state, RenderContext &context, ResourceManager &resources)
+bool GeometryList::begin(BuildState &state, RenderContext &context, ResourceManager &resources, StackAllocator<> const &scratch)
 {
   m_commandlump = {};
 
   state = {};
   state.context = &context;
   state.resources = &resources;
+  state.scratch = &scratch.arena();
 
   if (!context.ready)
     return false;
@@ -145,6 +186,18 @@ bool GeometryList::begin(BuildState &state, RenderContext &context, ResourceMana
 }
 
 
+///////////////////////// GeometryList::begin ///////////////////////////////
+bool GeometryList::begin(BuildState &state, RenderContext &context, ResourceManager &resources, StackAllocator<> const &scratch, Camera const &camera)
+{
+  auto result = begin(state, context, resources, scratch);
+
+  state.eye = camera.position();
+  state.forward = camera.forward();
+
+  return result;
+}
+
+
 ///////////////////////// GeometryList::bind_material ///////////////////////
 void GeometryList::bind_material(BuildState &state, Material const *material)
 {
@@ -181,6 +234,31 @@ void GeometryList::bind_material(BuildState &state, Material const *material)
 }
 
 
+///////////////////////// GeometryList::push_packet /////////////////////////
+GeometryList::Packet *GeometryList::push_packet(BuildState &state, int type, Mesh const *mesh, Material const *material, float depth)
+{
+  auto packet = acquire_record<Packet>(*state.scratch);
+
+  if (packet)
+  {
+    packet->key = packet_sortkey(type, material, mesh, depth);
+    packet->type = static_cast<Packet::Type>(type);
+    packet->mesh = mesh;
+    packet->material = material;
+    packet->instancecount = 0;
+    packet->instances = nullptr;
+    packet->modelset = VK_NULL_HANDLE;
+    packet->modelsetoffset = 0;
+    packet->chain = nullptr;
+    packet->next = state.packets;
+
+    state.packets = packet;
+  }
+
+  return packet;
+}
+
+
 ///////////////////////// GeometryList::push_mesh ///////////////////////////
 void GeometryList::push_mesh(BuildState &state, Transform const &transform, Mesh const *mesh, Material const *material)
 {
@@ -188,51 +266,61 @@ void GeometryList::push_mesh(BuildState &state, Transform const &transform, Mesh
   assert(mesh && mesh->ready());
   assert(material && material->ready());
 
-  auto &context = *state.context;
-  auto &commandlump = *state.commandlump;
+  // instances are accumulated per mesh & material in host scratch and drawn
+  // instanced when the packets are flushed
 
-  if (state.pipeline != context.modelgeometrypipeline)
-  {
-    bind_pipeline(prepasscommands, context.modelprepasspipeline, 0, 0, context.fbowidth, context.fboheight, VK_PIPELINE_BIND_POINT_GRAPHICS);
-    bind_pipeline(geometrycommands, context.modelgeometrypipeline, 0, 0, context.fbowidth, context.fboheight, VK_PIPELINE_BIND_POINT_GRAPHICS);
+  auto depth = dot(transform.translation() - state.eye, state.forward);
 
-    state.pipeline = context.modelgeometrypipeline;
-  }
+  auto hash = (reinterpret_cast<uintptr_t>(mesh) ^ reinterpret_cast<uintptr_t>(material) * 31) >> 4;
 
-  if (state.mesh != mesh)
-  {
-    bind_vertexbuffer(prepasscommands, 0, mesh->vertexbuffer);
-    bind_vertexbuffer(geometrycommands, 0, mesh->vertexbuffer);
+  auto &bucket = state.batches[hash % extent<decltype(state.batches)>::value];
 
-    state.mesh = mesh;
-  }
+  auto batch = bucket;
 
-  if (state.material != material)
+  while (batch && (batch->mesh != mesh || batch->material != material))
+    batch = batch->chain;
+
+  if (!batch)
   {
-    bind_material(state, material);
+    batch = push_packet(state, Packet::Model, mesh, material, depth);
 
-    state.material = material;
-  }
+    if (batch)
+    {
+      batch->chain = bucket;
 
-  if (state.modelset.available() < sizeof(ModelSet))
+      bucket = batch;
+    }
+  }
+  else
   {
-    state.modelset = commandlump.acquire_descriptor(context.modelsetlayout, sizeof(ModelSet), std::move(state.modelset));
+    // a batch draws once, at the depth of its nearest instance
+
+    batch->key = min(batch->key, packet_sortkey(Packet::Model, material, mesh, depth));
   }
 
-  if (state.modelset && state.materialset)
-  {
-    auto offset = state.modelset.reserve(sizeof(ModelSet));
+  auto instance = batch ? acquire_record<BatchInstance>(*state.scratch) : nullptr;
 
-    auto modelset = state.modelset.memory<ModelSet>(offset);
+  if (!instance)
+  {
+    BatchInstance single = { transform, nullptr };
 
-    modelset->modelworld = transform;
+    Packet packet = {};
+    packet.type = Packet::Model;
+    packet.mesh = mesh;
+    packet.material = material;
+    packet.instancecount = 1;
+    packet.instances = &single;
 
-    bind_descriptor(prepasscommands, context.pipelinelayout, ShaderLocation::modelset, state.modelset, offset, VK_PIPELINE_BIND_POINT_GRAPHICS);
-    bind_descriptor(geometrycommands, context.pipelinelayout, ShaderLocation::modelset, state.modelset, offset, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    draw_direct(state, packet);
 
-    draw(prepasscommands, mesh->vertexbuffer.indexcount, 1, 0, 0, 0);
-    draw(geometrycommands, mesh->vertexbuffer.indexcount, 1, 0, 0, 0);
+    return;
   }
+
+  instance->transform = transform;
+  instance->next = batch->instances;
+
+  batch->instances = instance;
+  batch->instancecount += 1;
 }
 
 
@@ -246,29 +334,32 @@ void GeometryList::push_mesh(BuildState &state, Transform const &transform, Pose
   auto &context = *state.context;
   auto &commandlump = *state.commandlump;
 
-  if (state.pipeline != context.actorgeometrypipeline)
+  VkDescriptorSet cachedset;
+  VkDeviceSize cachedoffset;
+
+  if (state.posecache && state.posecache->lookup(commandlump, &pose, transform, &cachedset, &cachedoffset))
   {
-//    bind_pipeline(prepasscommands, context.actorprepasspipeline, 0, 0, context.fbowidth, context.fboheight, VK_PIPELINE_BIND_POINT_GRAPHICS);
-    bind_pipeline(geometrycommands, context.actorgeometrypipeline, 0, 0, context.fbowidth, context.fboheight, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    auto packet = push_packet(state, Packet::Actor, mesh, material, dot(transform.translation() - state.eye, state.forward));
 
-    state.pipeline = context.actorgeometrypipeline;
-  }
+    Packet direct = {};
 
-  if (state.mesh != mesh)
-  {
-//    bind_vertexbuffer(prepasscommands, 0, mesh->vertexbuffer);
-    bind_vertexbuffer(geometrycommands, 0, mesh->vertexbuffer);
-//    bind_vertexbuffer(prepasscommands, 1, mesh->rigbuffer);
-    bind_vertexbuffer(geometrycommands, 1, mesh->rigbuffer);
+    if (!packet)
+    {
+      direct.type = Packet::Actor;
+      direct.mesh = mesh;
+      direct.material = material;
 
-    state.mesh = mesh;
-  }
+      packet = &direct;
+    }
 
-  if (state.material != material)
-  {
-    bind_material(state, material);
+    packet->instancecount = 1;
+    packet->modelset = cachedset;
+    packet->modelsetoffset = cachedoffset;
 
-    state.material = material;
+    if (packet == &direct)
+      draw_direct(state, direct);
+
+    return;
   }
 
   size_t actorsetsize = sizeof(ActorSet) + (pose.bonecount-1)*sizeof(Transform);
@@ -278,8 +369,21 @@ void GeometryList::push_mesh(BuildState &state, Transform const &transform, Pose
     state.modelset = commandlump.acquire_descriptor(context.modelsetlayout, actorsetsize, std::move(state.modelset));
   }
 
-  if (state.modelset && state.materialset)
+  if (state.modelset)
   {
+    auto packet = push_packet(state, Packet::Actor, mesh, material, dot(transform.translation() - state.eye, state.forward));
+
+    Packet direct = {};
+
+    if (!packet)
+    {
+      direct.type = Packet::Actor;
+      direct.mesh = mesh;
+      direct.material = material;
+
+      packet = &direct;
+    }
+
     auto offset = state.modelset.reserve(actorsetsize);
 
     auto modelset = state.modelset.memory<ActorSet>(offset);
@@ -288,11 +392,17 @@ void GeometryList::push_mesh(BuildState &state, Transform const &transform, Pose
 
     copy(pose.bones, pose.bones + pose.bonecount, modelset->bones);
 
-//    bind_descriptor(prepasscommands, context.pipelinelayout, ShaderLocation::modelset, state.modelset, offset, VK_PIPELINE_BIND_POINT_GRAPHICS);
-    bind_descriptor(geometrycommands, context.pipelinelayout, ShaderLocation::modelset, state.modelset, offset, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    if (state.posecache)
+    {
+      state.posecache->insert(state.modelset, offset, &pose, transform);
+    }
 
-//    draw(prepasscommands, mesh->vertexbuffer.indexcount, 1, 0, 0, 0);
-    draw(geometrycommands, mesh->vertexbuffer.indexcount, 1, 0, 0, 0);
+    packet->instancecount = 1;
+    packet->modelset = state.modelset;
+    packet->modelsetoffset = offset;
+
+    if (packet == &direct)
+      draw_direct(state, direct);
   }
 }
 
@@ -307,38 +417,28 @@ void GeometryList::push_foilage(BuildState &state, Transform const *transforms,
   auto &context = *state.context;
   auto &commandlump = *state.commandlump;
 
-  if (state.pipeline != context.foilagegeometrypipeline)
-  {
-    bind_pipeline(prepasscommands, context.foilageprepasspipeline, 0, 0, context.fbowidth, context.fboheight, VK_PIPELINE_BIND_POINT_GRAPHICS);
-    bind_pipeline(geometrycommands, context.foilagegeometrypipeline, 0, 0, context.fbowidth, context.fboheight, VK_PIPELINE_BIND_POINT_GRAPHICS);
-
-    state.pipeline = context.foilagegeometrypipeline;
-  }
+  size_t foilagesetsize = sizeof(FoilageSet) + (count-1)*sizeof(Transform);
 
-  if (state.mesh != mesh)
+  if (state.modelset.available() < foilagesetsize)
   {
-    bind_vertexbuffer(prepasscommands, 0, mesh->vertexbuffer);
-    bind_vertexbuffer(geometrycommands, 0, mesh->vertexbuffer);
-
-    state.mesh = mesh;
+    state.modelset = commandlump.acquire_descriptor(context.modelsetlayout, foilagesetsize, std::move(state.modelset));
   }
 
-  if (state.material != material)
+  if (state.modelset)
   {
-    bind_material(state, material);
+    auto packet = push_packet(state, Packet::Foilage, mesh, material, dot(transforms[0].translation() - state.eye, state.forward));
 
-    state.material = material;
-  }
+    Packet direct = {};
 
-  size_t foilagesetsize = sizeof(FoilageSet) + (count-1)*sizeof(Transform);
+    if (!packet)
+    {
+      direct.type = Packet::Foilage;
+      direct.mesh = mesh;
+      direct.material = material;
 
-  if (state.modelset.available() < foilagesetsize)
-  {
-    state.modelset = commandlump.acquire_descriptor(context.modelsetlayout, foilagesetsize, std::move(state.modelset));
-  }
+      packet = &direct;
+    }
 
-  if (state.modelset && state.materialset)
-  {
     auto offset = state.modelset.reserve(foilagesetsize);
 
     auto modelset = state.modelset.memory<FoilageSet>(offset);
@@ -352,11 +452,12 @@ void GeometryList::push_foilage(BuildState &state, Transform const *transforms,
       modelset->modelworlds[i] = transforms[i];
     }
 
-    bind_descriptor(prepasscommands, context.pipelinelayout, ShaderLocation::modelset, state.modelset, offset, VK_PIPELINE_BIND_POINT_GRAPHICS);
-    bind_descriptor(geometrycommands, context.pipelinelayout, ShaderLocation::modelset, state.modelset, offset, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    packet->instancecount = count;
+    packet->modelset = state.modelset;
+    packet->modelsetoffset = offset;
 
-    draw(prepasscommands, mesh->vertexbuffer.indexcount, count, 0, 0, 0);
-    draw(geometrycommands, mesh->vertexbuffer.indexcount, count, 0, 0, 0);
+    if (packet == &direct)
+      draw_direct(state, direct);
   }
 }
 
@@ -374,6 +475,9 @@ void GeometryList::push_terrain(BuildState &state, Transform const &transform, M
   auto &context = *state.context;
   auto &commandlump = *state.commandlump;
 
+  // pending packets were pushed ahead of this draw
+  flush_packets(state);
+
   if (state.pipeline != context.terraingeometrypipeline)
   {
     bind_pipeline(prepasscommands, context.terrainprepasspipeline, 0, 0, context.fbowidth, context.fboheight, VK_PIPELINE_BIND_POINT_GRAPHICS);
@@ -451,6 +555,9 @@ void GeometryList::push_ocean(GeometryList::BuildState &state, Transform const &
   auto &context = *state.context;
   auto &commandlump = *state.commandlump;
 
+  // pending packets were pushed ahead of this draw
+  flush_packets(state);
+
   if (state.pipeline != context.oceanpipeline)
   {
     bind_pipeline(geometrycommands, context.oceanpipeline, 0, 0, context.fbowidth, context.fboheight, VK_PIPELINE_BIND_POINT_GRAPHICS);
@@ -515,6 +622,174 @@ void GeometryList::push_ocean(GeometryList::BuildState &state, Transform const &
 }
 
 
+///////////////////////// GeometryList::flush_packets ///////////////////////
+void GeometryList::flush_packets(BuildState &state)
+{
+  assert(state.commandlump);
+
+  auto &context = *state.context;
+  auto &commandlump = *state.commandlump;
+
+  for(Packet const *packet = sort_packets(state.packets, *state.scratch); packet; packet = packet->next)
+  {
+    auto &mesh = packet->mesh;
+    auto &material = packet->material;
+
+    switch (packet->type)
+    {
+      case Packet::Model:
+        if (state.pipeline != context.modelgeometrypipeline)
+        {
+          bind_pipeline(prepasscommands, context.modelprepasspipeline, 0, 0, context.fbowidth, context.fboheight, VK_PIPELINE_BIND_POINT_GRAPHICS);
+          bind_pipeline(geometrycommands, context.modelgeometrypipeline, 0, 0, context.fbowidth, context.fboheight, VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+          state.pipeline = context.modelgeometrypipeline;
+          state.mesh = nullptr;
+        }
+
+        if (state.mesh != mesh)
+        {
+          bind_vertexbuffer(prepasscommands, 0, mesh->vertexbuffer);
+          bind_vertexbuffer(geometrycommands, 0, mesh->vertexbuffer);
+
+          state.mesh = mesh;
+        }
+        break;
+
+      case Packet::Actor:
+        if (state.pipeline != context.actorgeometrypipeline)
+        {
+//          bind_pipeline(prepasscommands, context.actorprepasspipeline, 0, 0, context.fbowidth, context.fboheight, VK_PIPELINE_BIND_POINT_GRAPHICS);
+          bind_pipeline(geometrycommands, context.actorgeometrypipeline, 0, 0, context.fbowidth, context.fboheight, VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+          state.pipeline = context.actorgeometrypipeline;
+          state.mesh = nullptr;
+        }
+
+        if (state.mesh != mesh)
+        {
+//          bind_vertexbuffer(prepasscommands, 0, mesh->vertexbuffer);
+          bind_vertexbuffer(geometrycommands, 0, mesh->vertexbuffer);
+//          bind_vertexbuffer(prepasscommands, 1, mesh->rigbuffer);
+          bind_vertexbuffer(geometrycommands, 1, mesh->rigbuffer);
+
+          state.mesh = mesh;
+        }
+        break;
+
+      case Packet::Foilage:
+        if (state.pipeline != context.foilagegeometrypipeline)
+        {
+          bind_pipeline(prepasscommands, context.foilageprepasspipeline, 0, 0, context.fbowidth, context.fboheight, VK_PIPELINE_BIND_POINT_GRAPHICS);
+          bind_pipeline(geometrycommands, context.foilagegeometrypipeline, 0, 0, context.fbowidth, context.fboheight, VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+          state.pipeline = context.foilagegeometrypipeline;
+          state.mesh = nullptr;
+        }
+
+        if (state.mesh != mesh)
+        {
+          bind_vertexbuffer(prepasscommands, 0, mesh->vertexbuffer);
+          bind_vertexbuffer(geometrycommands, 0, mesh->vertexbuffer);
+
+          state.mesh = mesh;
+        }
+        break;
+    }
+
+    if (state.material != material)
+    {
+      bind_material(state, material);
+
+      state.material = material;
+    }
+
+    if (!state.materialset)
+      continue;
+
+    switch (packet->type)
+    {
+      case Packet::Model:
+        {
+          auto instance = packet->instances;
+
+          for(size_t i = 0; i < packet->instancecount; )
+          {
+            size_t count = min(packet->instancecount - i, MaxBatchInstances);
+
+            size_t instancesetsize = sizeof(InstanceSet) + (count-1)*sizeof(Transform);
+
+            if (state.modelset.available() < instancesetsize)
+            {
+              state.modelset = commandlump.acquire_descriptor(context.modelsetlayout, instancesetsize, std::move(state.modelset));
+            }
+
+            if (!state.modelset)
+              break;
+
+            auto offset = state.modelset.reserve(instancesetsize);
+
+            auto modelset = state.modelset.memory<InstanceSet>(offset);
+
+            for(size_t k = 0; k < count; ++k, instance = instance->next)
+            {
+              modelset->modelworlds[k] = instance->transform;
+            }
+
+            bind_descriptor(prepasscommands, context.pipelinelayout, ShaderLocation::modelset, state.modelset, offset, VK_PIPELINE_BIND_POINT_GRAPHICS);
+            bind_descriptor(geometrycommands, context.pipelinelayout, ShaderLocation::modelset, state.modelset, offset, VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+            draw(prepasscommands, mesh->vertexbuffer.indexcount, count, 0, 0, 0);
+            draw(geometrycommands, mesh->vertexbuffer.indexcount, count, 0, 0, 0);
+
+            i += count;
+          }
+        }
+        break;
+
+      case Packet::Actor:
+//        bind_descriptor(prepasscommands, context.pipelinelayout, ShaderLocation::modelset, packet->modelset, packet->modelsetoffset, VK_PIPELINE_BIND_POINT_GRAPHICS);
+        bind_descriptor(geometrycommands, context.pipelinelayout, ShaderLocation::modelset, packet->modelset, packet->modelsetoffset, VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+//        draw(prepasscommands, mesh->vertexbuffer.indexcount, packet->instancecount, 0, 0, 0);
+        draw(geometrycommands, mesh->vertexbuffer.indexcount, packet->instancecount, 0, 0, 0);
+        break;
+
+      case Packet::Foilage:
+        bind_descriptor(prepasscommands, context.pipelinelayout, ShaderLocation::modelset, packet->modelset, packet->modelsetoffset, VK_PIPELINE_BIND_POINT_GRAPHICS);
+        bind_descriptor(geometrycommands, context.pipelinelayout, ShaderLocation::modelset, packet->modelset, packet->modelsetoffset, VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+        draw(prepasscommands, mesh->vertexbuffer.indexcount, packet->instancecount, 0, 0, 0);
+        draw(geometrycommands, mesh->vertexbuffer.indexcount, packet->instancecount, 0, 0, 0);
+        break;
+    }
+  }
+
+  for(auto &bucket : state.batches)
+    bucket = nullptr;
+
+  state.packets = nullptr;
+}
+
+
+///////////////////////// GeometryList::draw_direct /////////////////////////
+void GeometryList::draw_direct(BuildState &state, Packet &packet)
+{
+  // host scratch is exhausted, so rather than drop the draw, flush what is
+  // pending (keeping submission order) and record this packet on its own
+
+  LOG_ONCE("Geometry Scratch Exhausted");
+
+  flush_packets(state);
+
+  packet.next = nullptr;
+
+  state.packets = &packet;
+
+  flush_packets(state);
+}
+
+
 ///////////////////////// GeometryList::finalise ////////////////////////////
 void GeometryList::finalise(BuildState &state)
 {
@@ -522,6 +797,8 @@ void GeometryList::finalise(BuildState &state)
 
   auto &context = *state.context;
 
+  flush_packets(state);
+
   end(context.vulkan, prepasscommands);
   end(context.vulkan, geometrycommands);
 
@@ -30,6 +30,8 @@ class GeometryList
 
   public:
 
+    struct Packet;
+
     struct BuildState
     {
       RenderContext *context;
@@ -43,11 +45,25 @@ class GeometryList
 
       CommandLump *commandlump = nullptr;
 
+      Arena *scratch = nullptr;
+
+      PoseCache *posecache = nullptr;
+
+      lml::Vec3 eye = lml::Vec3(0.0f, 0.0f, 0.0f);
+      lml::Vec3 forward = lml::Vec3(0.0f, 0.0f, 0.0f);
+
       Mesh const *mesh;
       Material const *material;
+
+      Packet *packets;
+      Packet *batches[128];
     };
 
-    bool begin(BuildState &state, RenderContext &context, ResourceManager &resources);
+    // packet and batch records are built in host scratch memory
+    bool begin(BuildState &state, RenderContext &context, ResourceManager &resources, StackAllocator<> const &scratch);
+
+    // as above, also ordering draws of equal state front to back from camera
+    bool begin(BuildState &state, RenderContext &context, ResourceManager &resources, StackAllocator<> const &scratch, Camera const &camera);
 
     void push_mesh(BuildState &state, lml::Transform const &transform, Mesh const *mesh, Material const *material);
 
@@ -69,5 +85,11 @@ class GeometryList
 
   private:
 
+    Packet *push_packet(BuildState &state, int type, Mesh const *mesh, Material const *material, float depth);
+
+    void flush_packets(BuildState &state);
+
+    void draw_direct(BuildState &state, Packet &packet);
+
     unique_resource<CommandLump> m_commandlump;
 };
@@ -13,6 +13,19 @@ using namespace std;
 using namespace lml;
 using leap::extentof;
 
+///////////////////////// spotlight_bound ///////////////////////////////////
+Sphere spotlight_bound(Vec3 const &position, Vec3 const &direction, float range, float cutoff)
+{
+  if (cutoff > 0.707106f)
+    return Sphere(position + range / (2 * cutoff) * direction, range / (2 * cutoff));
+
+  if (cutoff > 0)
+    return Sphere(position + cutoff * range * direction, sqrt(1 - cutoff*cutoff) * range);
+
+  return Sphere(position, range);
+}
+
+
 //|---------------------- LightList -----------------------------------------
 //|--------------------------------------------------------------------------
 
@@ -56,9 +69,27 @@ bool LightList::begin(BuildState &state, RenderContext &context, ResourceManager
 }
 
 
+///////////////////////// LightList::begin //////////////////////////////////
+bool LightList::begin(BuildState &state, RenderContext &context, ResourceManager &resources, Camera const &camera)
+{
+  if (!begin(state, context, resources))
+    return false;
+
+  // lights outside the view are dropped at push, so only visible lights take up list capacity
+
+  state.cull = true;
+  state.frustum = camera.frustum();
+
+  return true;
+}
+
+
 ///////////////////////// LightList::push_pointlight ////////////////////////
 void LightList::push_pointlight(BuildState &state, Vec3 const &position, float range, Color3 const &intensity, Attenuation const &attenuation)
 {
+  if (state.cull && !intersects(state.frustum, Sphere(position, range)))
+    return;
+
   if (lightlist && lightlist->pointlightcount < extentof(lightlist->pointlights))
   {
     auto &entry = lightlist->pointlights[lightlist->pointlightcount];
@@ -78,6 +109,9 @@ void LightList::push_pointlight(BuildState &state, Vec3 const &position, float r
 ///////////////////////// LightList::push_spotlight /////////////////////////
 void LightList::push_spotlight(BuildState &state, Vec3 const &position, Vec3 const &direction, float cutoff, float range, Color3 const &intensity, Attenuation const &attenuation, lml::Transform const &spotview, SpotMap const *spotmap)
 {
+  if (state.cull && !intersects(state.frustum, spotlight_bound(position, direction, range, 1 - cutoff)))
+    return;
+
   if (lightlist && lightlist->spotlightcount < extentof(lightlist->spotlights))
   {
     auto &entry = lightlist->spotlights[lightlist->spotlightcount];
@@ -101,6 +135,9 @@ void LightList::push_spotlight(BuildState &state, Vec3 const &position, Vec3 con
 ///////////////////////// LightList::push_probe /////////////////////////////
 void LightList::push_probe(BuildState &state, Vec3 const &position, float radius, Irradiance const &irradiance)
 {
+  if (state.cull && !intersects(state.frustum, Sphere(position, radius)))
+    return;
+
   if (lightlist && lightlist->probecount < extentof(lightlist->probes))
   {
     auto &entry = lightlist->probes[lightlist->probecount];
@@ -118,6 +155,9 @@ void LightList::push_environment(BuildState &state, Transform const &transform,
 {
   assert(envmap && envmap->ready());
 
+  if (state.cull && !intersects(state.frustum, transform * Bound3(-size/2, size/2)))
+    return;
+
   if (lightlist && lightlist->environmentcount < extentof(lightlist->environments))
   {
     auto &entry = lightlist->environments[lightlist->environmentcount];
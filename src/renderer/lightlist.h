@@ -33,9 +33,13 @@ class LightList
       ResourceManager *resources;
 
       CommandLump *commandlump = nullptr;
+
+      bool cull;
+      lml::Frustum frustum;
     };
 
     bool begin(BuildState &state, RenderContext &context, ResourceManager &resources);
+    bool begin(BuildState &state, RenderContext &context, ResourceManager &resources, Camera const &camera);
 
     void push_pointlight(BuildState &state, lml::Vec3 const &position, float range, lml::Color3 const &intensity, lml::Attenuation const &attenuation);
 
@@ -55,3 +59,6 @@ class LightList
 
     unique_resource<CommandLump> m_commandlump;
 };
+
+// Bound (cutoff is the cosine of the cone half angle)
+lml::Sphere spotlight_bound(lml::Vec3 const &position, lml::Vec3 const &direction, float range, float cutoff);
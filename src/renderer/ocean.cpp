@@ -121,6 +121,29 @@ namespace
 
     return complex<float>(x, y) * sqrt((-2*log(w)) / w);
   }
+
+  void update_spectrum(OceanParams &params)
+  {
+    int size = OceanContext::WaveResolution;
+
+    float dk = 2*pi<float>() / params.wavescale;
+
+    for(int m = 0; m < size; ++m)
+    {
+      auto y = dk * (m - 0.5f*size);
+
+      for(int n = 0; n < size; ++n)
+      {
+        auto x = dk * (n - 0.5f*size);
+
+        auto h0 = dk * sqrt(phillips({x,y}, params.waveamplitude, params.windspeed, params.winddirection) / 2.0f);
+
+        params.height[m][n][0] = params.seed[m][n][0] * h0;
+        params.height[m][n][1] = params.seed[m][n][1] * h0;
+        params.omega[m][n] = dispersion({x,y});
+      }
+    }
+  }
 }
 
 
@@ -145,24 +168,7 @@ void seed_ocean(OceanParams &params)
     }
   }
 
-  int size = OceanContext::WaveResolution;
-
-  float dk = 2*pi<float>() / params.wavescale;
-
-  for(int m = 0; m < size; ++m)
-  {
-    auto y = dk * (m - 0.5f*size);
-
-    for(int n = 0; n < size; ++n)
-    {
-      auto x = dk * (n - 0.5f*size);
-
-      auto h0 = dk * sqrt(phillips({x,y}, params.waveamplitude, params.windspeed, params.winddirection) / 2.0f);
-
-      params.height[m][n][0] = params.seed[m][n][0] * h0;
-      params.height[m][n][1] = params.seed[m][n][1] * h0;
-    }
-  }
+  update_spectrum(params);
 
   params.flow = Vec2(0);
 }
@@ -191,24 +197,7 @@ void lerp_ocean_waves(OceanParams &params, float wavescale, float waveamplitude,
     params.windspeed = lerp(params.windspeed, windspeed, t);
     params.winddirection = normalise(lerp(params.winddirection, winddirection, t));
 
-    int size = OceanContext::WaveResolution;
-
-    float dk = 2*pi<float>() / params.wavescale;
-
-    for(int m = 0; m < size; ++m)
-    {
-      auto y = dk * (m - 0.5f*size);
-
-      for(int n = 0; n < size; ++n)
-      {
-        auto x = dk * (n - 0.5f*size);
-
-        auto h0 = dk * sqrt(phillips({x,y}, params.waveamplitude, params.windspeed, params.winddirection) / 2.0f);
-
-        params.height[m][n][0] = params.seed[m][n][0] * h0;
-        params.height[m][n][1] = params.seed[m][n][1] * h0;
-      }
-    }
+    update_spectrum(params);
   }
 }
 
@@ -216,20 +205,24 @@ void lerp_ocean_waves(OceanParams &params, float wavescale, float waveamplitude,
 ///////////////////////// update_ocean ////////////////////////////////////
 void update_ocean(OceanParams &params, float dt)
 {
-  int size = OceanContext::WaveResolution;
-
   params.swellphase = fmod(params.swellphase + (params.swellspeed * 2*pi<float>()/params.swelllength)*dt, 2*pi<float>());
 
-  for(int m = 0; m < size; ++m)
-  {
-    auto y = 2*pi<float>() * (m - 0.5f*size) / params.wavescale;
+  // frequencies are cached by update_spectrum, so the phase advance is a
+  // straight multiply-add over contiguous floats that the compiler vectorises
+  // (phase and omega are non-negative, so the wrap truncates rather than
+  // calling floor, which does not vectorise without SSE4.1)
 
-    for(int n = 0; n < size; ++n)
-    {
-      auto x = 2*pi<float>() * (n - 0.5f*size) / params.wavescale;
+  auto phase = &params.phase[0][0];
+  auto omega = &params.omega[0][0];
 
-      params.phase[m][n] = fmod(params.phase[m][n] + dispersion({x,y})*dt, 2*pi<float>());
-    }
+  const float tau = 2*pi<float>();
+  const float invtau = 1 / tau;
+
+  for(int i = 0; i < OceanContext::WaveResolution * OceanContext::WaveResolution; ++i)
+  {
+    auto theta = phase[i] + omega[i] * dt;
+
+    phase[i] = theta - tau * float(int(theta * invtau));
   }
 
   params.flow += params.windspeed * params.winddirection * dt;
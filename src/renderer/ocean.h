@@ -69,6 +69,7 @@ struct OceanParams
   float seed[OceanContext::WaveResolution][OceanContext::WaveResolution][2];
   float height[OceanContext::WaveResolution][OceanContext::WaveResolution][2];
   float phase[OceanContext::WaveResolution][OceanContext::WaveResolution];
+  float omega[OceanContext::WaveResolution][OceanContext::WaveResolution];
   lml::Vec2 flow;
 };
 
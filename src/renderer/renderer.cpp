@@ -15,6 +15,7 @@
 #include <limits>
 #include <random>
 #include <numeric>
+#include <fstream>
 #include "debug.h"
 
 using namespace std;
@@ -359,7 +360,7 @@ PushBuffer::PushBuffer(allocator_type const &allocator, size_t slabsize)
   m_slabsize = slabsize;
   m_slab = allocate<char>(allocator, m_slabsize, alignof(Header));
 
-  m_tail = m_slab;
+  reset();
 }
 
 
@@ -367,6 +368,9 @@ PushBuffer::PushBuffer(allocator_type const &allocator, size_t slabsize)
 void PushBuffer::reset()
 {
   m_tail = m_slab;
+
+  fill(std::begin(m_first), std::end(m_first), nullptr);
+  fill(std::begin(m_last), std::end(m_last), nullptr);
 }
 
 
@@ -387,8 +391,21 @@ void *PushBuffer::push(Renderable::Type type, size_t size, size_t alignment)
   if (!std::align(alignment, size, result, space))
     return nullptr;
 
+  assert(static_cast<size_t>(type) < TypeSlots);
+
   header->type = type;
   header->size = reinterpret_cast<uintptr_t>(result) + size - reinterpret_cast<uintptr_t>(header);
+  header->next = 0;
+
+  auto &first = m_first[static_cast<size_t>(type)];
+  auto &last = m_last[static_cast<size_t>(type)];
+
+  if (last)
+    last->next = reinterpret_cast<uintptr_t>(header) - reinterpret_cast<uintptr_t>(m_slab);
+  else
+    first = header;
+
+  last = header;
 
   m_tail = static_cast<char*>(result) + size;
 
@@ -396,6 +413,22 @@ void *PushBuffer::push(Renderable::Type type, size_t size, size_t alignment)
 }
 
 
+///////////////////////// PushBuffer::select ////////////////////////////////
+PushBuffer::const_select_range PushBuffer::select(Renderable::Type type) const
+{
+  Header const *heads[1] = { m_first[static_cast<size_t>(type)] };
+
+  return const_select_iterator(m_slab, heads, extentof(heads));
+}
+
+PushBuffer::const_select_range PushBuffer::select(Renderable::Type type1, Renderable::Type type2) const
+{
+  Header const *heads[2] = { m_first[static_cast<size_t>(type1)], m_first[static_cast<size_t>(type2)] };
+
+  return const_select_iterator(m_slab, heads, extentof(heads));
+}
+
+
 //|---------------------- Renderer ------------------------------------------
 //|--------------------------------------------------------------------------
 
@@ -475,6 +508,51 @@ void initialise_render_context(DatumPlatform::PlatformInterface &platform, Rende
 }
 
 
+///////////////////////// load_pipelinecache ////////////////////////////////
+PipelineCache load_pipelinecache(VulkanDevice const &vulkan, const char *path)
+{
+  vector<char> data;
+
+  ifstream fin(path, ios::binary);
+
+  if (fin)
+  {
+    fin.seekg(0, ios::end);
+
+    data.resize(fin.tellg());
+
+    fin.seekg(0, ios::beg);
+
+    fin.read(data.data(), data.size());
+
+    if (!fin)
+      data.clear();
+  }
+
+  return create_pipelinecache(vulkan, data.data(), data.size());
+}
+
+
+///////////////////////// save_pipelinecache ////////////////////////////////
+void save_pipelinecache(VulkanDevice const &vulkan, VkPipelineCache const *pipelinecaches, size_t count, const char *path)
+{
+  VkPipelineCacheCreateInfo pipelinecacheinfo = {};
+  pipelinecacheinfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+  auto pipelinecache = create_pipelinecache(vulkan, pipelinecacheinfo);
+
+  merge_pipelinecache(vulkan, pipelinecache, pipelinecaches, count);
+
+  vector<char> data(retreive_pipelinecache(vulkan, pipelinecache, nullptr, 0));
+
+  data.resize(retreive_pipelinecache(vulkan, pipelinecache, data.data(), data.size()));
+
+  ofstream fout(path, ios::binary | ios::trunc);
+
+  fout.write(data.data(), data.size());
+}
+
+
 ///////////////////////// prepare_render_context ////////////////////////////
 bool prepare_render_context(DatumPlatform::PlatformInterface &platform, RenderContext &context, AssetManager &assets)
 {
@@ -842,6 +920,8 @@ bool prepare_render_context(DatumPlatform::PlatformInterface &platform, RenderCo
     createinfo.pBindings = bindings;
 
     context.modelsetlayout = create_descriptorsetlayout(context.vulkan, createinfo);
+
+    context.resourcepool.register_dynamiclayout(context.modelsetlayout);
   }
 
   if (context.extendedsetlayout == 0)
@@ -875,7 +955,7 @@ bool prepare_render_context(DatumPlatform::PlatformInterface &platform, RenderCo
     // PipelineLayout
 
     VkPushConstantRange constants[1] = {};
-    constants[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    constants[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_GEOMETRY_BIT;
     constants[0].offset = 0;
     constants[0].size = PushConstantBufferSize;
 
@@ -6127,8 +6207,8 @@ void blit(RenderContext &context, Vulkan::Texture const &src, VkImage dst, int d
 }
 
 
-///////////////////////// prepare_shadowview ////////////////////////////////
-void prepare_shadowview(ShadowMap &shadowmap, Camera const &camera, Vec3 const &lightdirection)
+///////////////////////// shadow_cascades ///////////////////////////////////
+void shadow_cascades(ShadowMap const &shadowmap, Camera const &camera, Vec3 const &lightdirection, float *cascadesplits, Matrix4f *cascadeviews, Frustum *cascadefrustums)
 {
   const float lambda = shadowmap.shadowsplitlambda;
   const float znear = 0.1f;
@@ -6170,12 +6250,25 @@ void prepare_shadowview(ShadowMap &shadowmap, Camera const &camera, Vec3 const &
 
     auto lightproj = OrthographicProjection(-frustumradius, -frustumradius, frustumradius, frustumradius, 0.1f, extrusion + frustumradius) * ScaleMatrix(1.0f, -1.0f, 1.0f, 1.0f);
 
-    shadowmap.splits[i] = splits[i+1];
-    shadowmap.shadowview[i] = lightproj * inverse(lightview).matrix();
+    if (cascadesplits)
+      cascadesplits[i] = splits[i+1];
+
+    if (cascadeviews)
+      cascadeviews[i] = lightproj * inverse(lightview).matrix();
+
+    if (cascadefrustums)
+      cascadefrustums[i] = lightview * Frustum::orthographic(-frustumradius, -frustumradius, frustumradius, frustumradius, 0.1f, extrusion + frustumradius);
   }
 }
 
 
+///////////////////////// prepare_shadowview ////////////////////////////////
+void prepare_shadowview(ShadowMap &shadowmap, Camera const &camera, Vec3 const &lightdirection)
+{
+  shadow_cascades(shadowmap, camera, lightdirection, shadowmap.splits.data(), shadowmap.shadowview.data(), nullptr);
+}
+
+
 ///////////////////////// bind_decalmap /////////////////////////////////////
 uint32_t bind_decalmap(RenderContext &context, Vulkan::Texture const &texture)
 {
@@ -6251,7 +6344,7 @@ void prepare_sceneset(RenderContext &context, PushBuffer const &renderables, Ren
   VkDescriptorImageInfo envmapinfos[extentof(sceneset.environments)] = {};
   VkDescriptorImageInfo spotmapinfos[extentof(sceneset.spotlights)] = {};
 
-  for(auto &renderable : renderables)
+  for(auto &renderable : renderables.select(Renderable::Type::Lights, Renderable::Type::Decals))
   {
     if (renderable.type == Renderable::Type::Lights)
     {
@@ -6457,7 +6550,7 @@ void render(RenderContext &context, DatumPlatform::Viewport const &viewport, Cam
 
   beginpass(commandbuffer, context.shadowpass, context.shadowframebuffer, 0, 0, context.shadows.width, context.shadows.height, 1, &clearvalues[4]);
 
-  for(auto &renderable : renderables)
+  for(auto &renderable : renderables.select(Renderable::Type::Casters))
   {
     switch (renderable.type)
     {
@@ -6497,7 +6590,7 @@ void render(RenderContext &context, DatumPlatform::Viewport const &viewport, Cam
 
   beginpass(commandbuffer, context.prepass, context.preframebuffer, 0, 0, context.fbowidth, context.fboheight, 1, &clearvalues[3]);
 
-  for(auto &renderable : renderables)
+  for(auto &renderable : renderables.select(Renderable::Type::Geometry))
   {
     switch (renderable.type)
     {
@@ -6524,7 +6617,7 @@ void render(RenderContext &context, DatumPlatform::Viewport const &viewport, Cam
 
   beginpass(commandbuffer, context.geometrypass, context.geometryframebuffer, 0, 0, context.fbowidth, context.fboheight, 4, &clearvalues[0]);
 
-  for(auto &renderable : renderables)
+  for(auto &renderable : renderables.select(Renderable::Type::Geometry))
   {
     switch (renderable.type)
     {
@@ -6595,8 +6688,10 @@ void render(RenderContext &context, DatumPlatform::Viewport const &viewport, Cam
 
   auto &forwardcommands = context.forwardcommands[context.frame & 1];
 
-  bool solids = any_of(renderables.begin(), renderables.end(), [](auto &renderable) { return (renderable.type == Renderable::Type::Forward && renderable_cast<Renderable::Forward>(&renderable)->solidcommands); });
-  bool blends = any_of(renderables.begin(), renderables.end(), [](auto &renderable) { return (renderable.type == Renderable::Type::Forward && renderable_cast<Renderable::Forward>(&renderable)->blendcommands); });
+  auto forwards = renderables.select(Renderable::Type::Forward);
+
+  bool solids = any_of(forwards.begin(), forwards.end(), [](auto &renderable) { return (renderable.type == Renderable::Type::Forward && renderable_cast<Renderable::Forward>(&renderable)->solidcommands); });
+  bool blends = any_of(forwards.begin(), forwards.end(), [](auto &renderable) { return (renderable.type == Renderable::Type::Forward && renderable_cast<Renderable::Forward>(&renderable)->blendcommands); });
 
   beginpass(commandbuffer, context.forwardpass, context.forwardframebuffer, 0, 0, context.fbowidth, context.fboheight, 0, nullptr);
 
@@ -6608,7 +6703,7 @@ void render(RenderContext &context, DatumPlatform::Viewport const &viewport, Cam
 
     bind_descriptor(forwardcommands[0], context.pipelinelayout, ShaderLocation::sceneset, framedescriptor, VK_PIPELINE_BIND_POINT_GRAPHICS);
 
-    for(auto &renderable : renderables)
+    for(auto &renderable : forwards)
     {
       if (renderable.type == Renderable::Type::Forward && renderable_cast<Renderable::Forward>(&renderable)->solidcommands)
       {
@@ -6634,7 +6729,7 @@ void render(RenderContext &context, DatumPlatform::Viewport const &viewport, Cam
     clear(forwardcommands[1], 0, 0, context.fbowidth, context.fboheight, 0, Color4(0.0f, 0.0f, 0.0f, 1.0f));
     clear(forwardcommands[1], 0, 0, context.fbowidth, context.fboheight, 1, Color4(0.0f, 0.0f, 0.0f, 0.0f));
 
-    for(auto &renderable : renderables)
+    for(auto &renderable : forwards)
     {
       if (renderable.type == Renderable::Type::Forward && renderable_cast<Renderable::Forward>(&renderable)->blendcommands)
       {
@@ -6662,7 +6757,7 @@ void render(RenderContext &context, DatumPlatform::Viewport const &viewport, Cam
     draw(forwardcommands[2], context.unitquad.vertexcount, 1, 0, 0);
   }
 
-  for(auto &renderable : renderables)
+  for(auto &renderable : forwards)
   {
     if (renderable.type == Renderable::Type::Forward && renderable_cast<Renderable::Forward>(&renderable)->colorcommands)
     {
@@ -6769,7 +6864,7 @@ void render(RenderContext &context, DatumPlatform::Viewport const &viewport, Cam
 
   execute(commandbuffer, compositecommands);
 
-  for(auto &renderable : renderables)
+  for(auto &renderable : renderables.select(Renderable::Type::Sprites, Renderable::Type::Overlays))
   {
     switch (renderable.type)
     {
@@ -6813,11 +6908,11 @@ void render(RenderContext &context, DatumPlatform::Viewport const &viewport, Cam
   // Submit
   //
 
-  BEGIN_TIMED_BLOCK(Wait, Color3(0.1f, 0.1f, 0.1f))
+  BEGIN_TIMED_BLOCK(Wait, Color3(0.1f, 0.1f, 0.1f));
 
   wait_fence(context.vulkan, context.framefence);
 
-  END_TIMED_BLOCK(Wait)
+  END_TIMED_BLOCK(Wait);
 
   // Feedback
 
@@ -6828,20 +6923,20 @@ void render(RenderContext &context, DatumPlatform::Viewport const &viewport, Cam
   uint64_t timings[16];
   retreive_querypool(context.vulkan, context.timingquerypool, 0, 15, timings);
 
-  GPU_TIMED_BLOCK(Shadows, Color3(0.0f, 0.4f, 0.0f), timings[0], timings[1])
-  GPU_TIMED_BLOCK(PrePass, Color3(0.4f, 0.2f, 0.4f), timings[1], timings[2])
-  GPU_TIMED_BLOCK(Geometry, Color3(0.4f, 0.0f, 0.4f), timings[2], timings[3])
-  GPU_TIMED_BLOCK(Cluster, Color3(0.5f, 0.5f, 0.1f), timings[3], timings[4])
-  GPU_TIMED_BLOCK(SSAO, Color3(0.2f, 0.8f, 0.2f), timings[4], timings[5])
-  GPU_TIMED_BLOCK(Fog, Color3(0.0f, 0.2f, 0.2f), timings[5], timings[6])
-  GPU_TIMED_BLOCK(Lighting, Color3(0.0f, 0.6f, 0.4f), timings[6], timings[7])
-  GPU_TIMED_BLOCK(Forward, Color3(0.2f, 0.3f, 0.6f), timings[7], timings[8])
-  GPU_TIMED_BLOCK(Blur, Color3(0.2f, 0.5f, 0.2f), timings[8], timings[9])
-  GPU_TIMED_BLOCK(SSR, Color3(0.0f, 0.4f, 0.8f), timings[9], timings[10])
-  GPU_TIMED_BLOCK(Luminance, Color3(0.8f, 0.4f, 0.2f), timings[10], timings[11])
-  GPU_TIMED_BLOCK(Bloom, Color3(0.5f, 0.2f, 0.6f), timings[11], timings[12])
-  GPU_TIMED_BLOCK(Overlay, Color3(0.4f, 0.4f, 0.0f), timings[12], timings[13])
-  GPU_TIMED_BLOCK(Blit, Color3(0.4f, 0.4f, 0.4f), timings[13], timings[14])
+  GPU_TIMED_BLOCK(Shadows, Color3(0.0f, 0.4f, 0.0f), timings[0], timings[1]);
+  GPU_TIMED_BLOCK(PrePass, Color3(0.4f, 0.2f, 0.4f), timings[1], timings[2]);
+  GPU_TIMED_BLOCK(Geometry, Color3(0.4f, 0.0f, 0.4f), timings[2], timings[3]);
+  GPU_TIMED_BLOCK(Cluster, Color3(0.5f, 0.5f, 0.1f), timings[3], timings[4]);
+  GPU_TIMED_BLOCK(SSAO, Color3(0.2f, 0.8f, 0.2f), timings[4], timings[5]);
+  GPU_TIMED_BLOCK(Fog, Color3(0.0f, 0.2f, 0.2f), timings[5], timings[6]);
+  GPU_TIMED_BLOCK(Lighting, Color3(0.0f, 0.6f, 0.4f), timings[6], timings[7]);
+  GPU_TIMED_BLOCK(Forward, Color3(0.2f, 0.3f, 0.6f), timings[7], timings[8]);
+  GPU_TIMED_BLOCK(Blur, Color3(0.2f, 0.5f, 0.2f), timings[8], timings[9]);
+  GPU_TIMED_BLOCK(SSR, Color3(0.0f, 0.4f, 0.8f), timings[9], timings[10]);
+  GPU_TIMED_BLOCK(Luminance, Color3(0.8f, 0.4f, 0.2f), timings[10], timings[11]);
+  GPU_TIMED_BLOCK(Bloom, Color3(0.5f, 0.2f, 0.6f), timings[11], timings[12]);
+  GPU_TIMED_BLOCK(Overlay, Color3(0.4f, 0.4f, 0.0f), timings[12], timings[13]);
+  GPU_TIMED_BLOCK(Blit, Color3(0.4f, 0.4f, 0.4f), timings[13], timings[14]);
 
   GPU_SUBMIT();
 
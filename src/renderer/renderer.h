@@ -63,8 +63,9 @@ namespace Renderable
   {
     static constexpr Type type = Type::Geometry;
 
-    VkCommandBuffer prepasscommands;
-    VkCommandBuffer geometrycommands;
+    uint32_t sublistcount;
+    VkCommandBuffer const *prepasscommands;
+    VkCommandBuffer const *geometrycommands;
   };
 
   struct Forward
@@ -134,7 +135,8 @@ namespace Renderable
   {
     static constexpr Type type = Type::Casters;
 
-    VkCommandBuffer castercommands;
+    uint32_t sublistcount;
+    VkCommandBuffer const *castercommands;
   };
 
   struct Lights
@@ -151,7 +153,7 @@ namespace Renderable
         Color3 intensity;
         Vec4 attenuation;
 
-      } pointlights[256];
+      } pointlights[512];
 
       size_t spotlightcount;
 
@@ -175,7 +177,7 @@ namespace Renderable
         Vec4 position;
         Irradiance irradiance;
 
-      } probes[64];
+      } probes[128];
 
       size_t environmentcount;
 
@@ -224,10 +226,13 @@ class PushBuffer
 {
   public:
 
+    static constexpr size_t TypeSlots = 16;
+
     struct Header
     {
       Renderable::Type type;
       uint16_t size;
+      uint32_t next; // slab offset of the next header of this type, zero at end
     };
 
     class const_iterator
@@ -261,6 +266,73 @@ class PushBuffer
         Header const *m_header;
     };
 
+    class const_select_iterator
+    {
+      public:
+
+        using value_type = Header;
+        using pointer = Header const *;
+        using reference = Header const &;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+
+      public:
+        const_select_iterator() : m_slab(nullptr), m_count(0) { }
+        const_select_iterator(void const *slab, Header const * const *heads, size_t count) : m_slab(slab), m_count(count) { for(size_t i = 0; i < count; ++i) m_cursors[i] = heads[i]; }
+
+        bool operator ==(const_select_iterator const &that) const { return current() == that.current(); }
+        bool operator !=(const_select_iterator const &that) const { return current() != that.current(); }
+
+        Header const &operator *() const { return *current(); }
+        Header const *operator ->() const { return current(); }
+
+        const_select_iterator &operator++()
+        {
+          auto header = current();
+
+          for(size_t i = 0; i < m_count; ++i)
+          {
+            if (m_cursors[i] == header)
+              m_cursors[i] = header->next ? reinterpret_cast<Header const *>(static_cast<char const *>(m_slab) + header->next) : nullptr;
+          }
+
+          return *this;
+        }
+
+      private:
+
+        Header const *current() const
+        {
+          Header const *header = nullptr;
+
+          for(size_t i = 0; i < m_count; ++i)
+          {
+            if (m_cursors[i] && (!header || m_cursors[i] < header))
+              header = m_cursors[i];
+          }
+
+          return header;
+        }
+
+        void const *m_slab;
+
+        size_t m_count;
+        Header const *m_cursors[4];
+    };
+
+    class const_select_range
+    {
+      public:
+        const_select_range(const_select_iterator const &first) : m_first(first) { }
+
+        const_select_iterator begin() const { return m_first; }
+        const_select_iterator end() const { return const_select_iterator(); }
+
+      private:
+
+        const_select_iterator m_first;
+    };
+
   public:
 
     using allocator_type = StackAllocator<>;
@@ -290,6 +362,10 @@ class PushBuffer
     const_iterator begin() const { return const_iterator(reinterpret_cast<Header*>(m_slab)); }
     const_iterator end() const { return const_iterator(reinterpret_cast<Header*>(m_tail)); }
 
+    // Iterate only the renderables of the given types, in push order
+    const_select_range select(Renderable::Type type) const;
+    const_select_range select(Renderable::Type type1, Renderable::Type type2) const;
+
   protected:
 
     void *push(Renderable::Type type, size_t size, size_t alignment);
@@ -300,6 +376,9 @@ class PushBuffer
 
     void *m_slab;
     void *m_tail;
+
+    Header *m_first[TypeSlots];
+    Header *m_last[TypeSlots];
 };
 
 template<typename T>
@@ -523,6 +602,10 @@ void config_render_pipeline(RenderPipelineConfig config, T value);
 // Initialise
 void initialise_render_context(DatumPlatform::PlatformInterface &platform, RenderContext &context, size_t storagesize, uint32_t queueindex);
 
+// Pipeline Cache
+Vulkan::PipelineCache load_pipelinecache(Vulkan::VulkanDevice const &vulkan, const char *path);
+void save_pipelinecache(Vulkan::VulkanDevice const &vulkan, VkPipelineCache const *pipelinecaches, size_t count, const char *path);
+
 // Prepare
 bool prepare_render_context(DatumPlatform::PlatformInterface &platform, RenderContext &context, AssetManager &assets);
 void prepare_render_pipeline(RenderContext &context, RenderParams const &params);
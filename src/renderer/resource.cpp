@@ -49,7 +49,7 @@ void ResourceManager::initialise_slab(size_t slabsize)
   m_slat.resize((nslots - 1) / 64 + 1);
   m_slatsize = nslots;
 
-  RESOURCE_USE(ResourceSlot, (m_slatused = 0), m_slatsize)
+  RESOURCE_USE(ResourceSlot, (m_slatused = 0), m_slatsize);
 
   m_deletershead = 0;
   m_deleterstail = 0;
@@ -86,7 +86,7 @@ void *ResourceManager::acquire_slot(size_t size)
         for(j = i; j < i+nslots; ++j)
           m_slat[j >> 6][j & 0x3F] = 1;
 
-        RESOURCE_USE(ResourceSlot, (m_slatused += nslots), m_slatsize)
+        RESOURCE_USE(ResourceSlot, (m_slatused += nslots), m_slatsize);
 
         m_slathead = j;
 
@@ -118,7 +118,7 @@ void ResourceManager::release_slot(void *slot, size_t size)
   for(size_t j = i; j < i+nslots; ++j)
     m_slat[j >> 6][j & 0x3F] = 0;
 
-  RESOURCE_USE(ResourceSlot, (m_slatused -= nslots), m_slatsize)
+  RESOURCE_USE(ResourceSlot, (m_slatused -= nslots), m_slatsize);
 
   m_slathead = min(m_slathead, i);
 }
@@ -161,7 +161,7 @@ void ResourceManager::initialise_device(VkPhysicalDevice physicaldevice, VkDevic
 
   assert(vulkan.physicaldeviceproperties.limits.minMemoryMapAlignment >= alignof(Buffer));
 
-  RESOURCE_USE(ResourceBuffer, (m_bufferused = 0), m_buffersallocated)
+  RESOURCE_USE(ResourceBuffer, (m_bufferused = 0), m_buffersallocated);
 }
 
 
@@ -212,7 +212,7 @@ ResourceManager::TransferLump const *ResourceManager::acquire_lump(size_t size)
         (*into)->size = (*into)->used;
         (*into)->next = buffer;
 
-        RESOURCE_USE(ResourceBuffer, (m_bufferused += bytes), m_buffersallocated)
+        RESOURCE_USE(ResourceBuffer, (m_bufferused += bytes), m_buffersallocated);
 
         return &buffer->transferlump;
       }
@@ -244,7 +244,7 @@ ResourceManager::TransferLump const *ResourceManager::acquire_lump(size_t size)
 
       m_buffersallocated += buffer->size;
 
-      RESOURCE_USE(ResourceBuffer, m_bufferused, m_buffersallocated)
+      RESOURCE_USE(ResourceBuffer, m_bufferused, m_buffersallocated);
     }
   }
 
@@ -277,7 +277,7 @@ void ResourceManager::release_lump(TransferLump const *lump)
 
       next->~Buffer();
 
-      RESOURCE_USE(ResourceBuffer, m_bufferused, m_buffersallocated)
+      RESOURCE_USE(ResourceBuffer, m_bufferused, m_buffersallocated);
 
       return;
     }
@@ -288,7 +288,7 @@ void ResourceManager::release_lump(TransferLump const *lump)
 
       buffer->~Buffer();
 
-      RESOURCE_USE(ResourceBuffer, m_bufferused, m_buffersallocated)
+      RESOURCE_USE(ResourceBuffer, m_bufferused, m_buffersallocated);
 
       *into = next;
       buffer = next;
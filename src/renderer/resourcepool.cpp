@@ -17,18 +17,6 @@ using namespace Vulkan;
 using leap::alignto;
 using leap::extentof;
 
-namespace
-{
-  size_t tid()
-  {
-    static std::atomic<size_t> threadcount(0);
-    static thread_local size_t threadid = threadcount++;
-
-    return threadid;
-  }
-
-} // namespace
-
 
 ///////////////////////// ResourcePool::initialise //////////////////////////
 void ResourcePool::initialise(VkPhysicalDevice physicaldevice, VkDevice device, VkQueue renderqueue, uint32_t renderqueuefamily, size_t storagesize)
@@ -83,8 +71,22 @@ void ResourcePool::initialise(VkPhysicalDevice physicaldevice, VkDevice device,
     m_lumps[i].descriptorpool.pool = create_descriptorpool(vulkan, descriptorpoolinfo);
   }
 
-  RESOURCE_USE(RenderLump, (m_lumpsused = 0), ResourceLumpCount)
-  RESOURCE_USE(RenderStorage, (m_storageused = 0), m_transferbuffer.size)
+  VkDescriptorPoolSize dynamiccounts[1] = {};
+  dynamiccounts[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+  dynamiccounts[0].descriptorCount = DynamicSetSlots;
+
+  VkDescriptorPoolCreateInfo dynamicpoolinfo = {};
+  dynamicpoolinfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  dynamicpoolinfo.maxSets = DynamicSetSlots;
+  dynamicpoolinfo.poolSizeCount = extentof(dynamiccounts);
+  dynamicpoolinfo.pPoolSizes = dynamiccounts;
+
+  m_dynamicpool = create_descriptorpool(vulkan, dynamicpoolinfo);
+
+  m_dynamicsetcount = 0;
+
+  RESOURCE_USE(RenderLump, (m_lumpsused = 0), ResourceLumpCount);
+  RESOURCE_USE(RenderStorage, (m_storageused = 0), m_transferbuffer.size);
 
   m_initialised = true;
 }
@@ -124,7 +126,7 @@ ResourcePool::ResourceLump const *ResourcePool::acquire_lump()
   if (!m_initialised)
     return nullptr;
 
-  static thread_local int lumphead = (tid() % 8) * 8;
+  static thread_local int lumphead = (thread_index() % 8) * 8;
 
   for(size_t i = 0; i < ResourceLumpCount; ++i)
   {
@@ -132,7 +134,7 @@ ResourcePool::ResourceLump const *ResourcePool::acquire_lump()
 
     if (lump.lock.test_and_set(std::memory_order_acquire) == false)
     {
-      RESOURCE_USE(RenderLump, (m_lumpsused += 1), ResourceLumpCount)
+      RESOURCE_USE(RenderLump, (m_lumpsused += 1), ResourceLumpCount);
 
       return &lump;
     }
@@ -152,7 +154,7 @@ void ResourcePool::release_lump(ResourceLump const *lumphandle)
 
   ResourceLump &lump = m_lumps[lumphandle - m_lumps];
 
-  RESOURCE_USE(RenderLump, (m_lumpsused -= 1), ResourceLumpCount)
+  RESOURCE_USE(RenderLump, (m_lumpsused -= 1), ResourceLumpCount);
 
   reset(lump.storagepool);
   reset(lump.commandpool);
@@ -198,7 +200,7 @@ ResourcePool::StorageBuffer ResourcePool::acquire_storagebuffer(ResourceLump con
     {
       if (buffer.refcount == 0)
       {
-        RESOURCE_USE(RenderStorage, (m_storageused -= buffer.used), m_transferbuffer.size)
+        RESOURCE_USE(RenderStorage, (m_storageused -= buffer.used), m_transferbuffer.size);
 
         buffer.used = 0;
       }
@@ -209,7 +211,7 @@ ResourcePool::StorageBuffer ResourcePool::acquire_storagebuffer(ResourceLump con
 
         buffer.refcount += 1;
 
-        RESOURCE_USE(RenderStorage, (m_storageused += buffer.size - buffer.used), m_transferbuffer.size)
+        RESOURCE_USE(RenderStorage, (m_storageused += buffer.size - buffer.used), m_transferbuffer.size);
 
         m_storagehead = i;
 
@@ -236,7 +238,7 @@ void ResourcePool::release_storagebuffer(StorageBuffer const &storage, size_t us
 
   StorageSlot &buffer = m_storagebuffers[storage.storagebuffer - m_storagebuffers];
 
-  RESOURCE_USE(RenderStorage, (m_storageused -= buffer.size - buffer.used - used), m_transferbuffer.size)
+  RESOURCE_USE(RenderStorage, (m_storageused -= buffer.size - buffer.used - used), m_transferbuffer.size);
 
   buffer.used = alignto(buffer.used + used, storage.alignment);
 
@@ -244,6 +246,35 @@ void ResourcePool::release_storagebuffer(StorageBuffer const &storage, size_t us
 }
 
 
+///////////////////////// ResourcePool::retain_storage //////////////////////
+bool ResourcePool::retain_storagebuffer(ResourceLump const *lumphandle, StorageBuffer const &storage)
+{
+  assert(m_initialised);
+  assert(lumphandle >= m_lumps && lumphandle - m_lumps < ResourceLumpCount);
+  assert(storage.storagebuffer >= m_storagebuffers && storage.storagebuffer - m_storagebuffers < StorageBufferSlots);
+
+  ResourceLump &lump = m_lumps[lumphandle - m_lumps];
+
+  // holds the storage slot until this lump is released, so a lump can
+  // reference storage written through another lump
+
+  for(size_t i = 0; i < lump.storagepool.count; ++i)
+  {
+    if (lump.storagepool.buffers[i] == storage.storagebuffer)
+      return true;
+  }
+
+  if (lump.storagepool.count == extentof(lump.storagepool.buffers))
+    return false;
+
+  lump.storagepool.buffers[lump.storagepool.count++] = storage.storagebuffer;
+
+  m_storagebuffers[storage.storagebuffer - m_storagebuffers].refcount += 1;
+
+  return true;
+}
+
+
 ///////////////////////// ResourcePool::acquire_descriptorset ///////////////
 ResourcePool::DescriptorSet ResourcePool::acquire_descriptorset(ResourceLump const *lumphandle, VkDescriptorSetLayout layout)
 {
@@ -257,6 +288,44 @@ ResourcePool::DescriptorSet ResourcePool::acquire_descriptorset(ResourceLump con
 }
 
 
+///////////////////////// ResourcePool::register_dynamiclayout //////////////
+void ResourcePool::register_dynamiclayout(VkDescriptorSetLayout layout)
+{
+  assert(m_initialised);
+  assert(m_dynamicsetcount < DynamicSetSlots);
+
+  // a single set per layout spans the whole storage buffer, every storage
+  // slot is then addressed by dynamic offset without further set updates
+
+  if (acquire_dynamicset(layout))
+    return;
+
+  auto &entry = m_dynamicsets[m_dynamicsetcount];
+
+  entry.layout = layout;
+  entry.descriptorset = allocate_descriptorset(vulkan, m_dynamicpool, layout).release();
+
+  bind_buffer(vulkan, entry.descriptorset, 0, m_transferbuffer, 0, m_storagebuffers[0].size, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC);
+
+  m_dynamicsetcount.fetch_add(1, std::memory_order_release);
+}
+
+
+///////////////////////// ResourcePool::acquire_dynamicset //////////////////
+ResourcePool::DescriptorSet ResourcePool::acquire_dynamicset(VkDescriptorSetLayout layout) const
+{
+  auto count = m_dynamicsetcount.load(std::memory_order_acquire);
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    if (m_dynamicsets[i].layout == layout)
+      return { m_dynamicsets[i].descriptorset };
+  }
+
+  return { VK_NULL_HANDLE };
+}
+
+
 ///////////////////////// initialise_resource_pool //////////////////////////
 bool initialise_resource_pool(DatumPlatform::PlatformInterface &platform, ResourcePool &resourcepool, size_t storagesize, uint32_t queueindex)
 {
@@ -23,6 +23,7 @@ class ResourcePool
     static constexpr int CommandBufferSlots = 128;
     static constexpr int DescriptorSetSlots = 512;
     static constexpr int ResourceLumpCount = 64;
+    static constexpr int DynamicSetSlots = 8;
 
   private:
 
@@ -102,6 +103,14 @@ class ResourcePool
       std::atomic_flag lock = ATOMIC_FLAG_INIT;
     };
 
+  private:
+
+    struct DynamicSet
+    {
+      VkDescriptorSetLayout layout;
+      VkDescriptorSet descriptorset;
+    };
+
   public:
 
     // initialise resource pool
@@ -124,10 +133,18 @@ class ResourcePool
 
     void release_storagebuffer(StorageBuffer const &storage, size_t used);
 
+    bool retain_storagebuffer(ResourceLump const *lump, StorageBuffer const &storage);
+
     // descriptor sets
 
     DescriptorSet acquire_descriptorset(ResourceLump const *lump, VkDescriptorSetLayout layout);
 
+    // dynamic descriptor sets (layouts holding a single dynamic storage buffer)
+
+    void register_dynamiclayout(VkDescriptorSetLayout layout);
+
+    DescriptorSet acquire_dynamicset(VkDescriptorSetLayout layout) const;
+
   private:
 
     Vulkan::VulkanDevice vulkan;
@@ -138,6 +155,12 @@ class ResourcePool
 
     ResourceLump m_lumps[ResourceLumpCount];
 
+    Vulkan::DescriptorPool m_dynamicpool;
+
+    std::atomic<size_t> m_dynamicsetcount;
+
+    DynamicSet m_dynamicsets[DynamicSetSlots];
+
 #ifndef NDEBUG
     std::atomic<size_t> m_lumpsused;
     std::atomic<size_t> m_storageused;
@@ -88,6 +88,56 @@ namespace
   {
     return width * height * sizeof(uint32_t);
   }
+
+  ///////////////////////// hash_combine ////////////////////////////////////
+  uint64_t hash_combine(uint64_t hash, void const *data, size_t bytes)
+  {
+    for(auto ch = static_cast<uint8_t const *>(data); bytes != 0; ++ch, --bytes)
+    {
+      hash = (hash ^ *ch) * 1099511628211ull;
+    }
+
+    return hash;
+  }
+
+  ///////////////////////// hash_resources //////////////////////////////////
+  uint64_t hash_resources(uint64_t hash, Mesh const *mesh, Material const *material)
+  {
+    // device handles change when a resource is reloaded or recreated in place
+
+    VkBuffer vertices = mesh->vertexbuffer.vertices;
+    VkBuffer indices = mesh->vertexbuffer.indices;
+    VkImage albedomap = material->albedomap ? material->albedomap->texture.image : VK_NULL_HANDLE;
+
+    hash = hash_combine(hash, &mesh, sizeof(mesh));
+    hash = hash_combine(hash, &vertices, sizeof(vertices));
+    hash = hash_combine(hash, &indices, sizeof(indices));
+    hash = hash_combine(hash, &mesh->vertexbuffer.indexcount, sizeof(mesh->vertexbuffer.indexcount));
+    hash = hash_combine(hash, &material, sizeof(material));
+    hash = hash_combine(hash, &albedomap, sizeof(albedomap));
+
+    return hash;
+  }
+
+  ///////////////////////// spotlight_visible ///////////////////////////////
+  bool spotlight_visible(SpotCasterList::BuildState const &state, Bound3 const &bound)
+  {
+    if (!state.cull)
+      return true;
+
+    auto centre = bound.centre();
+    auto radius = norm(bound.halfdim());
+
+    auto offset = centre - state.spotposition;
+    auto along = dot(offset, state.spotdirection);
+
+    if (along < -radius || along > state.spotrange + radius)
+      return false;
+
+    auto across = norm(offset - along * state.spotdirection);
+
+    return across * state.spotcutoff - along * sqrt(1 - state.spotcutoff*state.spotcutoff) < radius;
+  }
 }
 
 //|---------------------- SpotCasterList ------------------------------------
@@ -128,6 +178,24 @@ bool SpotCasterList::begin(BuildState &state, SpotMapContext &context, ResourceM
 
   state.commandlump = commandlump;
 
+  state.hash = 14695981039346656037ull;
+
+  return true;
+}
+
+
+///////////////////////// SpotCasterList::begin /////////////////////////////
+bool SpotCasterList::begin(BuildState &state, SpotMapContext &context, ResourceManager &resources, Transform const &spotview, float cutoff, float range)
+{
+  if (!begin(state, context, resources))
+    return false;
+
+  state.cull = true;
+  state.spotposition = spotview.translation();
+  state.spotdirection = spotview.rotation() * Vec3(0, 0, -1);
+  state.spotcutoff = 1 - cutoff;
+  state.spotrange = range;
+
   return true;
 }
 
@@ -139,6 +207,9 @@ void SpotCasterList::push_mesh(BuildState &state, Transform const &transform, Me
   assert(mesh && mesh->ready());
   assert(material && material->ready());
 
+  if (!spotlight_visible(state, transform * mesh->bound))
+    return;
+
   auto &context = *state.context;
   auto &commandlump = *state.commandlump;
 
@@ -188,6 +259,10 @@ void SpotCasterList::push_mesh(BuildState &state, Transform const &transform, Me
     bind_descriptor(castercommands, context.pipelinelayout, ShaderLocation::modelset, state.modelset, offset, VK_PIPELINE_BIND_POINT_GRAPHICS);
 
     draw(castercommands, mesh->vertexbuffer.indexcount, 1, 0, 0, 0);
+
+    state.hash = hash_combine(state.hash, &state.pipeline, sizeof(state.pipeline));
+    state.hash = hash_resources(state.hash, mesh, material);
+    state.hash = hash_combine(state.hash, &transform, sizeof(transform));
   }
 }
 
@@ -199,6 +274,9 @@ void SpotCasterList::push_mesh(BuildState &state, Transform const &transform, Po
   assert(mesh && mesh->ready());
   assert(material && material->ready());
 
+  if (!spotlight_visible(state, transform * mesh->bound))
+    return;
+
   auto &context = *state.context;
   auto &commandlump = *state.commandlump;
 
@@ -233,26 +311,48 @@ void SpotCasterList::push_mesh(BuildState &state, Transform const &transform, Po
     }
   }
 
-  size_t actorsetsize = sizeof(ActorSet) + (pose.bonecount-1)*sizeof(Transform);
+  VkDescriptorSet modelset = VK_NULL_HANDLE;
+  VkDeviceSize modelsetoffset = 0;
 
-  if (state.modelset.available() < actorsetsize)
+  if (!state.posecache || !state.posecache->lookup(commandlump, &pose, transform, &modelset, &modelsetoffset))
   {
-    state.modelset = commandlump.acquire_descriptor(context.modelsetlayout, actorsetsize, std::move(state.modelset));
-  }
+    size_t actorsetsize = sizeof(ActorSet) + (pose.bonecount-1)*sizeof(Transform);
 
-  if (state.modelset && state.materialset)
-  {
-    auto offset = state.modelset.reserve(actorsetsize);
+    if (state.modelset.available() < actorsetsize)
+    {
+      state.modelset = commandlump.acquire_descriptor(context.modelsetlayout, actorsetsize, std::move(state.modelset));
+    }
 
-    auto modelset = state.modelset.memory<ActorSet>(offset);
+    if (state.modelset)
+    {
+      auto offset = state.modelset.reserve(actorsetsize);
 
-    modelset->modelworld = transform;
+      auto actorset = state.modelset.memory<ActorSet>(offset);
 
-    copy(pose.bones, pose.bones + pose.bonecount, modelset->bones);
+      actorset->modelworld = transform;
 
-    bind_descriptor(castercommands, context.pipelinelayout, ShaderLocation::modelset, state.modelset, offset, VK_PIPELINE_BIND_POINT_GRAPHICS);
+      copy(pose.bones, pose.bones + pose.bonecount, actorset->bones);
+
+      if (state.posecache)
+      {
+        state.posecache->insert(state.modelset, offset, &pose, transform);
+      }
+
+      modelset = state.modelset;
+      modelsetoffset = offset;
+    }
+  }
+
+  if (modelset && state.materialset)
+  {
+    bind_descriptor(castercommands, context.pipelinelayout, ShaderLocation::modelset, modelset, modelsetoffset, VK_PIPELINE_BIND_POINT_GRAPHICS);
 
     draw(castercommands, mesh->vertexbuffer.indexcount, 1, 0, 0, 0);
+
+    state.hash = hash_combine(state.hash, &state.pipeline, sizeof(state.pipeline));
+    state.hash = hash_resources(state.hash, mesh, material);
+    state.hash = hash_combine(state.hash, &transform, sizeof(transform));
+    state.hash = hash_combine(state.hash, pose.bones, pose.bonecount*sizeof(Transform));
   }
 }
 
@@ -314,14 +414,29 @@ void SpotCasterList::push_foilage(BuildState &state, Transform const *transforms
     modelset->bendscale = bendscale;
     modelset->detailbendscale = detailbendscale;
 
+    size_t visible = 0;
+
     for(size_t i = 0; i < count; ++i)
     {
-      modelset->modelworlds[i] = transforms[i];
+      if (spotlight_visible(state, transforms[i] * mesh->bound))
+      {
+        modelset->modelworlds[visible++] = transforms[i];
+      }
     }
 
-    bind_descriptor(castercommands, context.pipelinelayout, ShaderLocation::modelset, state.modelset, offset, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    if (visible != 0)
+    {
+      bind_descriptor(castercommands, context.pipelinelayout, ShaderLocation::modelset, state.modelset, offset, VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+      draw(castercommands, mesh->vertexbuffer.indexcount, visible, 0, 0, 0);
 
-    draw(castercommands, mesh->vertexbuffer.indexcount, count, 0, 0, 0);
+      state.hash = hash_combine(state.hash, &state.pipeline, sizeof(state.pipeline));
+      state.hash = hash_resources(state.hash, mesh, material);
+      state.hash = hash_combine(state.hash, &wind, sizeof(wind));
+      state.hash = hash_combine(state.hash, &bendscale, sizeof(bendscale));
+      state.hash = hash_combine(state.hash, &detailbendscale, sizeof(detailbendscale));
+      state.hash = hash_combine(state.hash, modelset->modelworlds, visible*sizeof(Transform));
+    }
   }
 }
 
@@ -335,6 +450,8 @@ void SpotCasterList::finalise(BuildState &state)
 
   end(context.vulkan, castercommands);
 
+  hash = state.hash;
+
   state.commandlump = nullptr;
 }
 
@@ -358,6 +475,7 @@ SpotMap const *ResourceManager::create<SpotMap>(Asset const *asset)
 
   spotmap->width = asset->width;
   spotmap->height = asset->height;
+  spotmap->hash = 0;
   spotmap->asset = asset;
   spotmap->transferlump = nullptr;
   spotmap->state = SpotMap::State::Empty;
@@ -379,6 +497,7 @@ SpotMap const *ResourceManager::create<SpotMap>(int width, int height)
 
   spotmap->width = width;
   spotmap->height = height;
+  spotmap->hash = 0;
   spotmap->asset = nullptr;
   spotmap->transferlump = nullptr;
   spotmap->state = SpotMap::State::Empty;
@@ -1114,14 +1233,51 @@ void render_spotmaps(SpotMapContext &context, SpotMapInfo const *spotmaps, size_
 
   begin(context.vulkan, commandbuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 
+  uint64_t hashes[extentof(context.srcblitcommands)] = {};
+
   for(size_t i = 0; i < spotmapcount; ++i)
   {
     auto &target = spotmaps[i].target;
     auto &source = spotmaps[i].source;
     auto &casters = spotmaps[i].casters;
+    auto &castercount = spotmaps[i].castercount;
 
     assert(target->ready() && target->asset == nullptr);
 
+    //
+    // Skip maps whose inputs are unchanged since their last submit. Static
+    // casters belong in a separately rendered SpotMap passed as the source,
+    // so that only the dynamic casters invalidate the target.
+    //
+
+    auto hash = hash_combine(14695981039346656037ull, &spotmaps[i].spotview, sizeof(spotmaps[i].spotview));
+
+    VkImage targetimage = target->texture.image;
+
+    hash = hash_combine(hash, &targetimage, sizeof(targetimage));
+
+    if (source)
+    {
+      VkImage sourceimage = source->texture.image;
+
+      hash = hash_combine(hash, &source, sizeof(source));
+      hash = hash_combine(hash, &sourceimage, sizeof(sourceimage));
+      hash = hash_combine(hash, &source->hash, sizeof(source->hash));
+    }
+
+    for(size_t k = 0; casters && k < castercount; ++k)
+    {
+      if (casters[k].castercommands)
+      {
+        hash = hash_combine(hash, &casters[k].hash, sizeof(casters[k].hash));
+      }
+    }
+
+    if (target->hash == hash)
+      continue;
+
+    hashes[i] = hash;
+
     prepare_framebuffer(context, target);
 
     prepare_sceneset(context, spotmaps[i]);
@@ -1147,9 +1303,12 @@ void render_spotmaps(SpotMapContext &context, SpotMapInfo const *spotmaps, size_
       execute(commandbuffer, srcblitcommands);
     }
 
-    if (casters->castercommands)
+    for(size_t k = 0; casters && k < castercount; ++k)
     {
-      execute(commandbuffer, casters->castercommands);
+      if (casters[k].castercommands)
+      {
+        execute(commandbuffer, casters[k].castercommands);
+      }
     }
 
     endpass(commandbuffer, context.renderpass);
@@ -1162,4 +1321,12 @@ void render_spotmaps(SpotMapContext &context, SpotMapInfo const *spotmaps, size_
   //
 
   submit(context.vulkan, context.commandbuffer, context.rendercomplete, context.fence, dependancies);
+
+  for(size_t i = 0; i < spotmapcount; ++i)
+  {
+    if (hashes[i] != 0)
+    {
+      spotmaps[i].target->hash = hashes[i];
+    }
+  }
 }
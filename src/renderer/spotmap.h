@@ -35,6 +35,8 @@ class SpotMap
 
     mutable Vulkan::FrameBuffer framebuffer;
 
+    mutable uint64_t hash;
+
   public:
 
     enum class State
@@ -65,6 +67,8 @@ class SpotCasterList
 
     VkCommandBuffer castercommands;
 
+    uint64_t hash;
+
     explicit operator bool() const { return *m_commandlump; }
 
   public:
@@ -85,11 +89,22 @@ class SpotCasterList
 
       CommandLump *commandlump = nullptr;
 
+      PoseCache *posecache = nullptr;
+
       Mesh const *mesh;
       Material const *material;
+
+      bool cull;
+      lml::Vec3 spotposition;
+      lml::Vec3 spotdirection;
+      float spotcutoff;
+      float spotrange;
+
+      uint64_t hash;
     };
 
     bool begin(BuildState &state, SpotMapContext &context, ResourceManager &resources);
+    bool begin(BuildState &state, SpotMapContext &context, ResourceManager &resources, lml::Transform const &spotview, float cutoff, float range);
 
     void push_mesh(BuildState &state, lml::Transform const &transform, Mesh const *mesh, Material const *material);
 
@@ -158,6 +173,7 @@ struct SpotMapInfo
 
   SpotMap const *source = nullptr;
   SpotCasterList const *casters = nullptr;
+  size_t castercount = 1;
 };
 
 struct SpotMapParams
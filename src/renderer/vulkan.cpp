@@ -367,6 +367,60 @@ namespace Vulkan
   }
 
 
+  ///////////////////////// create_pipelinecache ////////////////////////////
+  PipelineCache create_pipelinecache(VulkanDevice const &vulkan, void const *data, size_t size)
+  {
+    VkPipelineCacheCreateInfo pipelinecacheinfo = {};
+    pipelinecacheinfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+    struct Header
+    {
+      uint32_t headersize;
+      uint32_t headerversion;
+      uint32_t vendorid;
+      uint32_t deviceid;
+      uint8_t uuid[VK_UUID_SIZE];
+    };
+
+    static_assert(sizeof(Header) == 16 + VK_UUID_SIZE, "invalid header size");
+
+    Header header;
+
+    if (data && size >= sizeof(header))
+    {
+      memcpy(&header, data, sizeof(header));
+
+      auto &properties = vulkan.physicaldeviceproperties;
+
+      if (header.headersize >= sizeof(header) && header.headersize <= size && header.headerversion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE && header.vendorid == properties.vendorID && header.deviceid == properties.deviceID && memcmp(header.uuid, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0)
+      {
+        pipelinecacheinfo.initialDataSize = size;
+        pipelinecacheinfo.pInitialData = data;
+      }
+    }
+
+    return create_pipelinecache(vulkan, pipelinecacheinfo);
+  }
+
+
+  ///////////////////////// retreive_pipelinecache //////////////////////////
+  size_t retreive_pipelinecache(VulkanDevice const &vulkan, VkPipelineCache pipelinecache, void *data, size_t size)
+  {
+    if (vkGetPipelineCacheData(vulkan.device, pipelinecache, &size, data) < VK_SUCCESS)
+      throw runtime_error("Vulkan vkGetPipelineCacheData failed");
+
+    return size;
+  }
+
+
+  ///////////////////////// merge_pipelinecache /////////////////////////////
+  void merge_pipelinecache(VulkanDevice const &vulkan, VkPipelineCache pipelinecache, VkPipelineCache const *sources, size_t count)
+  {
+    if (vkMergePipelineCaches(vulkan.device, pipelinecache, count, sources) != VK_SUCCESS)
+      throw runtime_error("Vulkan vkMergePipelineCaches failed");
+  }
+
+
   ///////////////////////// create_descriptorpool ///////////////////////////
   DescriptorPool create_descriptorpool(VulkanDevice const &vulkan, VkDescriptorPoolCreateInfo const &createinfo)
   {
@@ -1755,6 +1809,11 @@ namespace Vulkan
     vkCmdExecuteCommands(commandbuffer, 1, &buffer);
   }
 
+  void execute(VkCommandBuffer commandbuffer, VkCommandBuffer const *buffers, uint32_t count)
+  {
+    vkCmdExecuteCommands(commandbuffer, count, buffers);
+  }
+
 
   ///////////////////////// push ////////////////////////////////////////////
   void push(VkCommandBuffer commandbuffer, VkPipelineLayout layout, VkDeviceSize offset, VkDeviceSize size, const void *data, VkShaderStageFlags stage)
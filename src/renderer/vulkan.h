@@ -371,6 +371,10 @@ namespace Vulkan
   Pipeline create_pipeline(VulkanDevice const &vulkan, VkPipelineCache cache, VkComputePipelineCreateInfo const &createinfo);
 
   PipelineCache create_pipelinecache(VulkanDevice const &vulkan, VkPipelineCacheCreateInfo const &createinfo);
+  PipelineCache create_pipelinecache(VulkanDevice const &vulkan, void const *data, size_t size);
+
+  size_t retreive_pipelinecache(VulkanDevice const &vulkan, VkPipelineCache pipelinecache, void *data, size_t size);
+  void merge_pipelinecache(VulkanDevice const &vulkan, VkPipelineCache pipelinecache, VkPipelineCache const *sources, size_t count);
 
   DescriptorPool create_descriptorpool(VulkanDevice const &vulkan, VkDescriptorPoolCreateInfo const &createinfo);
 
@@ -509,6 +513,7 @@ namespace Vulkan
   void scissor(VkCommandBuffer commandbuffer, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
 
   void execute(VkCommandBuffer commandbuffer, VkCommandBuffer buffer);
+  void execute(VkCommandBuffer commandbuffer, VkCommandBuffer const *buffers, uint32_t count);
 
   void push(VkCommandBuffer commandbuffer, VkPipelineLayout layout, VkDeviceSize offset, VkDeviceSize size, const void *data, VkShaderStageFlags stage);
 
@@ -26,14 +26,42 @@ RenderList::RenderList(allocator_type const &allocator, std::size_t slabsize)
 ///////////////////////// RenderList::push_geometry /////////////////////////
 void RenderList::push_geometry(GeometryList const &geometrylist)
 {
-  if (geometrylist)
+  push_geometry(&geometrylist, 1);
+}
+
+
+///////////////////////// RenderList::push_geometry /////////////////////////
+void RenderList::push_geometry(GeometryList const *geometrylists, size_t count)
+{
+  // sublists may be built concurrently, they are executed in the order given
+
+  auto sublistcount = count_if(geometrylists, geometrylists + count, [](auto &geometrylist) { return bool(geometrylist); });
+
+  if (sublistcount == 0)
+    return;
+
+  // the command buffer arrays trail the entry in the push buffer
+
+  auto entry = m_buffer.push<Renderable::Geometry>(sizeof(Renderable::Geometry) + 2*sublistcount*sizeof(VkCommandBuffer));
+
+  if (entry)
   {
-    auto entry = m_buffer.push<Renderable::Geometry>();
+    auto prepasscommands = reinterpret_cast<VkCommandBuffer*>(entry + 1);
+    auto geometrycommands = prepasscommands + sublistcount;
 
-    if (entry)
+    entry->sublistcount = 0;
+    entry->prepasscommands = prepasscommands;
+    entry->geometrycommands = geometrycommands;
+
+    for(size_t i = 0; i < count; ++i)
     {
-      entry->prepasscommands = geometrylist.prepasscommands;
-      entry->geometrycommands = geometrylist.geometrycommands;
+      if (geometrylists[i])
+      {
+        prepasscommands[entry->sublistcount] = geometrylists[i].prepasscommands;
+        geometrycommands[entry->sublistcount] = geometrylists[i].geometrycommands;
+
+        entry->sublistcount += 1;
+      }
     }
   }
 }
@@ -59,13 +87,35 @@ void RenderList::push_forward(ForwardList const &forwardlist)
 ///////////////////////// RenderList::push_casters //////////////////////////
 void RenderList::push_casters(CasterList const &casterlist)
 {
-  if (casterlist)
+  push_casters(&casterlist, 1);
+}
+
+
+///////////////////////// RenderList::push_casters //////////////////////////
+void RenderList::push_casters(CasterList const *casterlists, size_t count)
+{
+  auto sublistcount = count_if(casterlists, casterlists + count, [](auto &casterlist) { return bool(casterlist); });
+
+  if (sublistcount == 0)
+    return;
+
+  auto entry = m_buffer.push<Renderable::Casters>(sizeof(Renderable::Casters) + sublistcount*sizeof(VkCommandBuffer));
+
+  if (entry)
   {
-    auto entry = m_buffer.push<Renderable::Casters>();
+    auto castercommands = reinterpret_cast<VkCommandBuffer*>(entry + 1);
 
-    if (entry)
+    entry->sublistcount = 0;
+    entry->castercommands = castercommands;
+
+    for(size_t i = 0; i < count; ++i)
     {
-      entry->castercommands = casterlist.castercommands;
+      if (casterlists[i])
+      {
+        castercommands[entry->sublistcount] = casterlists[i].castercommands;
+
+        entry->sublistcount += 1;
+      }
     }
   }
 }
@@ -29,10 +29,12 @@ class RenderList
     operator PushBuffer const &() const { return m_buffer; }
 
     void push_geometry(GeometryList const &geometrylist);
+    void push_geometry(GeometryList const *geometrylists, size_t count);
 
     void push_forward(ForwardList const &forwardlist);
 
     void push_casters(CasterList const &casterlist);
+    void push_casters(CasterList const *casterlists, size_t count);
 
     void push_lights(LightList const &lightlist);
 
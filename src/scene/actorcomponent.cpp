@@ -17,7 +17,7 @@ using namespace lml;
 
 ///////////////////////// MeshStorage::Constructor //////////////////////////
 ActorComponentStorage::ActorComponentStorage(Scene *scene, StackAllocator<> allocator)
-  : DefaultStorage(scene, allocator),
+  : DenseStorage(scene, allocator),
     m_allocator(allocator, m_freelist),
     m_tree(StackAllocatorWithFreelist<>(allocator, m_treefreelist))
 {
@@ -32,33 +32,24 @@ void ActorComponentStorage::clear()
 
   m_staticpartition = 1;
 
-  DefaultStorage::clear();
+  DenseStorage::clear();
 }
 
 
 ///////////////////////// MeshStorage::add //////////////////////////////////
 void ActorComponentStorage::add(EntityId entity, Bound3 const &bound, Mesh const *mesh, Material const *material, int flags)
 {
-  size_t index = 0;
+  auto index = insert(entity);
 
   if (flags & ActorComponent::Static)
   {
-    index = insert(entity);
+    // static rows stay ahead of the dynamic rows
 
-    if (index > m_staticpartition)
-    {
-      for_each(m_data, [=](auto &v) { swap(v[index], v[m_staticpartition]); });
-
-      swap(m_index[data<0>(index).index()], m_index[entity.index()]);
+    swap_rows(index, m_staticpartition);
 
-      index = m_staticpartition;
-    }
+    index = m_staticpartition;
 
-    m_staticpartition = max(m_staticpartition, index + 1);
-  }
-  else
-  {
-    index = append(entity);
+    m_staticpartition += 1;
   }
 
   set_entity(index, entity);
@@ -72,7 +63,7 @@ void ActorComponentStorage::add(EntityId entity, Bound3 const &bound, Mesh const
 
   if (flags & ActorComponent::Static)
   {
-    m_tree.insert(MeshIndex{ index, this });
+    m_tree.insert(MeshIndex{ entity, this });
   }
 }
 
@@ -80,6 +71,9 @@ void ActorComponentStorage::add(EntityId entity, Bound3 const &bound, Mesh const
 ///////////////////////// MeshStorage::remove ///////////////////////////////
 void ActorComponentStorage::remove(EntityId entity)
 {
+  if (!has(entity))
+    return;
+
   auto index = m_index[entity.index()];
 
   animator(index)->~Animator();
@@ -88,22 +82,17 @@ void ActorComponentStorage::remove(EntityId entity)
 
   if (index < m_staticpartition)
   {
-    m_tree.remove(MeshIndex{ index, this });
-
-    for_each(m_data, [=](auto &v) { v[index] = {}; });
+    m_tree.remove(MeshIndex{ entity, this });
 
-    m_freeslots.push_back(index);
-  }
-  else
-  {
-    for_each(m_data, [=](auto &v) { swap(v[index], v[v.size()-1]); });
+    // close the hole with the last static row, leaving it at the front of
+    // the dynamic rows for the swap and pop below
 
-    for_each(m_data, [](auto &v) { v.resize(v.size()-1); });
+    swap_rows(index, m_staticpartition - 1);
 
-    m_index[data<0>(index).index()] = index;
+    m_staticpartition -= 1;
   }
 
-  m_index[entity.index()] = 0;
+  DenseStorage::remove(entity);
 }
 
 
@@ -112,6 +101,17 @@ void ActorComponentStorage::update_mesh_bounds()
 {
   auto transformstorage = m_scene->system<TransformComponentStorage>();
 
+  if (4*m_moves > size())
+  {
+    // removes have moved a quarter of the rows out of entity order, restore
+    // it (within each partition) to keep the transform lookups in order
+
+    sort(1, m_staticpartition);
+    sort(m_staticpartition, size());
+
+    m_moves = 0;
+  }
+
   for(size_t index = m_staticpartition; index < size(); ++index)
   {
     assert(transformstorage->has(entity(index)));
@@ -157,8 +157,8 @@ void Scene::initialise_component_storage<ActorComponent>()
 //|--------------------------------------------------------------------------
 
 ///////////////////////// ActorComponent::Constructor ///////////////////////
-ActorComponent::ActorComponent(size_t index, ActorComponentStorage *storage)
-  : index(index),
+ActorComponent::ActorComponent(Scene::EntityId entity, ActorComponentStorage *storage)
+  : entity(entity),
     storage(storage)
 {
 }
@@ -181,7 +181,7 @@ ActorComponent Scene::add_component<ActorComponent>(Scene::EntityId entity, Mesh
 
   storage->add(entity, bound, mesh, material, flags);
 
-  return { storage->index(entity), storage };
+  return { entity, storage };
 }
 
 template<>
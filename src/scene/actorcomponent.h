@@ -18,7 +18,7 @@
 //|---------------------- ActorComponentStorage -----------------------------
 //|--------------------------------------------------------------------------
 
-class ActorComponentStorage : public DefaultStorage<Scene::EntityId, int, lml::Bound3, Mesh const *, Material const *, Animator *>
+class ActorComponentStorage : public DenseStorage<Scene::EntityId, int, lml::Bound3, Mesh const *, Material const *, Animator *>
 {
   public:
     ActorComponentStorage(Scene *scene, StackAllocator<> allocator);
@@ -26,38 +26,40 @@ class ActorComponentStorage : public DefaultStorage<Scene::EntityId, int, lml::B
     template<typename Component = class ActorComponent>
     Component get(EntityId entity)
     {
-      return { this->index(entity), this };
+      return { entity, this };
     }
 
     void update_mesh_bounds();
 
   public:
 
+    // tree entries hold the entity, static rows move as others are removed
+
     struct MeshIndex
     {
       operator EntityId() const
       {
-        return storage->data<0>(index);
+        return entity;
       }
 
       lml::Bound3 const &box() const
       {
-        return storage->data<2>(index);
+        return storage->data<2>(storage->index(entity));
       }
 
       friend bool operator ==(MeshIndex const &lhs, MeshIndex const &rhs)
       {
-        return lhs.index == rhs.index;
+        return lhs.entity == rhs.entity;
       }
 
-      size_t index;
+      EntityId entity;
       ActorComponentStorage *storage;
     };
 
     template<typename Component = class ActorComponent>
     Component get(MeshIndex const &index)
     {
-      return { index.index, this };
+      return { index.entity, this };
     }
 
     typedef leap::lml::RTree::basic_rtree<MeshIndex, 3, leap::lml::RTree::box<MeshIndex>, StackAllocatorWithFreelist<>>::const_iterator tree_iterator;
@@ -137,21 +139,23 @@ class ActorComponent
 
   public:
     ActorComponent() = default;
-    ActorComponent(size_t index, ActorComponentStorage *storage);
+    ActorComponent(Scene::EntityId entity, ActorComponentStorage *storage);
 
-    int flags() const { return storage->flags(index); }
+    int flags() const { return storage->flags(index()); }
 
-    lml::Bound3 const &bound() const { return storage->bound(index); }
+    lml::Bound3 const &bound() const { return storage->bound(index()); }
 
-    Mesh const *mesh() const { return storage->mesh(index); }
-    Material const *material() const { return storage->material(index); }
+    Mesh const *mesh() const { return storage->mesh(index()); }
+    Material const *material() const { return storage->material(index()); }
 
-    Animator *animator() const { return storage->animator(index); }
+    Animator *animator() const { return storage->animator(index()); }
 
-    Pose const &pose() const { return storage->animator(index)->pose; }
+    Pose const &pose() const { return storage->animator(index())->pose; }
 
   protected:
 
-    size_t index;
+    size_t index() const { return storage->index(entity); }
+
+    Scene::EntityId entity;
     ActorComponentStorage *storage;
 };
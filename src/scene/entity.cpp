@@ -32,3 +32,15 @@ Scene::EntityId Scene::create<Entity>()
 {
   return add_entity<Entity>();
 }
+
+
+///////////////////////// Entity::create ////////////////////////////////////
+void Scene::create(size_t count, EntityId *entities)
+{
+  reserve(m_slots.size() + count - min(count, m_freeslots.size()));
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    entities[i] = add_entity<Entity>();
+  }
+}
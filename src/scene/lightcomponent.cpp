@@ -17,7 +17,7 @@ using namespace lml;
 
 ///////////////////////// PointLightStorage::Constructor //////////////////////////
 PointLightComponentStorage::PointLightComponentStorage(Scene *scene, StackAllocator<> allocator)
-  : DefaultStorage(scene, allocator)
+  : DenseStorage(scene, allocator)
 {
 }
 
@@ -46,8 +46,8 @@ void Scene::initialise_component_storage<PointLightComponent>()
 //|--------------------------------------------------------------------------
 
 ///////////////////////// PointLightComponent::Constructor //////////////////
-PointLightComponent::PointLightComponent(size_t index, PointLightComponentStorage *storage)
-  : index(index),
+PointLightComponent::PointLightComponent(Scene::EntityId entity, PointLightComponentStorage *storage)
+  : entity(entity),
     storage(storage)
 {
 }
@@ -56,18 +56,18 @@ PointLightComponent::PointLightComponent(size_t index, PointLightComponentStorag
 ///////////////////////// PointLightComponent::set_intensity ////////////////
 void PointLightComponent::set_intensity(Color3 const &intensity)
 {
-  storage->set_intensity(index, intensity);
+  storage->set_intensity(index(), intensity);
 
-  storage->set_range(index, lml::range(attenuation(), max_element(intensity)));
+  storage->set_range(index(), lml::range(attenuation(), max_element(intensity)));
 }
 
 
 ///////////////////////// PointLightComponent::set_attenuation //////////////
 void PointLightComponent::set_attenuation(Attenuation const &attenuation)
 {
-  storage->set_attenuation(index, attenuation);
+  storage->set_attenuation(index(), attenuation);
 
-  storage->set_range(index, lml::range(attenuation, max_element(intensity())));
+  storage->set_range(index(), lml::range(attenuation, max_element(intensity())));
 }
 
 
@@ -83,7 +83,7 @@ PointLightComponent Scene::add_component<PointLightComponent>(Scene::EntityId en
 
   storage->add(entity, intensity, attenuation);
 
-  return { storage->index(entity), storage };
+  return { entity, storage };
 }
 
 
@@ -122,7 +122,7 @@ PointLightComponent Scene::get_component<PointLightComponent>(Scene::EntityId en
 
 ///////////////////////// SpotLightStorage::Constructor //////////////////////////
 SpotLightComponentStorage::SpotLightComponentStorage(Scene *scene, StackAllocator<> allocator)
-  : DefaultStorage(scene, allocator)
+  : DenseStorage(scene, allocator)
 {
 }
 
@@ -153,8 +153,8 @@ void Scene::initialise_component_storage<SpotLightComponent>()
 //|--------------------------------------------------------------------------
 
 ///////////////////////// SpotLightComponent::Constructor //////////////////
-SpotLightComponent::SpotLightComponent(size_t index, SpotLightComponentStorage *storage)
-  : index(index),
+SpotLightComponent::SpotLightComponent(Scene::EntityId entity, SpotLightComponentStorage *storage)
+  : entity(entity),
     storage(storage)
 {
 }
@@ -163,18 +163,18 @@ SpotLightComponent::SpotLightComponent(size_t index, SpotLightComponentStorage *
 ///////////////////////// SpotLightComponent::set_intensity ////////////////
 void SpotLightComponent::set_intensity(Color3 const &intensity, float maxrange)
 {
-  storage->set_intensity(index, intensity);
+  storage->set_intensity(index(), intensity);
 
-  storage->set_range(index, min(lml::range(attenuation(), max_element(intensity)), maxrange));
+  storage->set_range(index(), min(lml::range(attenuation(), max_element(intensity)), maxrange));
 }
 
 
 ///////////////////////// SpotLightComponent::set_attenuation //////////////
 void SpotLightComponent::set_attenuation(Attenuation const &attenuation, float maxrange)
 {
-  storage->set_attenuation(index, attenuation);
+  storage->set_attenuation(index(), attenuation);
 
-  storage->set_range(index, min(lml::range(attenuation, max_element(intensity())), maxrange));
+  storage->set_range(index(), min(lml::range(attenuation, max_element(intensity())), maxrange));
 }
 
 
@@ -190,7 +190,7 @@ SpotLightComponent Scene::add_component<SpotLightComponent>(Scene::EntityId enti
 
   storage->add(entity, cutoff, maxrange, intensity, attenuation, shadowmap);
 
-  return { storage->index(entity), storage };
+  return { entity, storage };
 }
 
 
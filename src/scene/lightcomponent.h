@@ -17,7 +17,7 @@
 //|---------------------- PointLightComponentStorage ------------------------
 //|--------------------------------------------------------------------------
 
-class PointLightComponentStorage : public DefaultStorage<Scene::EntityId, float, lml::Color3, lml::Attenuation>
+class PointLightComponentStorage : public DenseStorage<Scene::EntityId, float, lml::Color3, lml::Attenuation>
 {
   public:
     PointLightComponentStorage(Scene *scene, StackAllocator<> allocator);
@@ -25,7 +25,7 @@ class PointLightComponentStorage : public DefaultStorage<Scene::EntityId, float,
     template<typename Component = class PointLightComponent>
     Component get(EntityId entity)
     {
-      return { this->index(entity), this };
+      return { entity, this };
     }
 
   protected:
@@ -60,18 +60,20 @@ class PointLightComponent
 
   public:
     PointLightComponent() = default;
-    PointLightComponent(size_t index, PointLightComponentStorage *storage);
+    PointLightComponent(Scene::EntityId entity, PointLightComponentStorage *storage);
 
-    float range() const { return storage->range(index); }
-    lml::Color3 const &intensity() const { return storage->intensity(index); }
-    lml::Attenuation const &attenuation() const { return storage->attenuation(index); }
+    float range() const { return storage->range(index()); }
+    lml::Color3 const &intensity() const { return storage->intensity(index()); }
+    lml::Attenuation const &attenuation() const { return storage->attenuation(index()); }
 
     void set_intensity(lml::Color3 const &intensity);
     void set_attenuation(lml::Attenuation const &attenuation);
 
   protected:
 
-    size_t index;
+    size_t index() const { return storage->index(entity); }
+
+    Scene::EntityId entity;
     PointLightComponentStorage *storage;
 };
 
@@ -79,7 +81,7 @@ class PointLightComponent
 //|---------------------- SpotLightComponentStorage -------------------------
 //|--------------------------------------------------------------------------
 
-class SpotLightComponentStorage : public DefaultStorage<Scene::EntityId, float, float, lml::Color3, lml::Attenuation, SpotMap const *>
+class SpotLightComponentStorage : public DenseStorage<Scene::EntityId, float, float, lml::Color3, lml::Attenuation, SpotMap const *>
 {
   public:
     SpotLightComponentStorage(Scene *scene, StackAllocator<> allocator);
@@ -87,7 +89,7 @@ class SpotLightComponentStorage : public DefaultStorage<Scene::EntityId, float,
     template<typename Component = class SpotLightComponent>
     Component get(EntityId entity)
     {
-      return { this->index(entity), this };
+      return { entity, this };
     }
 
   protected:
@@ -126,20 +128,22 @@ class SpotLightComponent
 
   public:
     SpotLightComponent() = default;
-    SpotLightComponent(size_t index, SpotLightComponentStorage *storage);
+    SpotLightComponent(Scene::EntityId entity, SpotLightComponentStorage *storage);
 
-    float range() const { return storage->range(index); }
-    float cutoff() const { return storage->cutoff(index); }
-    lml::Color3 const &intensity() const { return storage->intensity(index); }
-    lml::Attenuation const &attenuation() const { return storage->attenuation(index); }
-    SpotMap const *shadowmap() const { return storage->shadowmap(index); }
+    float range() const { return storage->range(index()); }
+    float cutoff() const { return storage->cutoff(index()); }
+    lml::Color3 const &intensity() const { return storage->intensity(index()); }
+    lml::Attenuation const &attenuation() const { return storage->attenuation(index()); }
+    SpotMap const *shadowmap() const { return storage->shadowmap(index()); }
 
     void set_intensity(lml::Color3 const &intensity, float maxrange);
     void set_attenuation(lml::Attenuation const &attenuation, float maxrange);
 
   protected:
 
-    size_t index;
+    size_t index() const { return storage->index(entity); }
+
+    Scene::EntityId entity;
     SpotLightComponentStorage *storage;
 };
 
@@ -17,7 +17,7 @@ using namespace lml;
 
 ///////////////////////// MeshStorage::Constructor //////////////////////////
 MeshComponentStorage::MeshComponentStorage(Scene *scene, StackAllocator<> allocator)
-  : DefaultStorage(scene, allocator),
+  : DenseStorage(scene, allocator),
     m_tree(StackAllocatorWithFreelist<>(allocator, m_treefreelist))
 {
   m_staticpartition = 1;
@@ -31,33 +31,24 @@ void MeshComponentStorage::clear()
 
   m_staticpartition = 1;
 
-  DefaultStorage::clear();
+  DenseStorage::clear();
 }
 
 
 ///////////////////////// MeshStorage::add //////////////////////////////////
 void MeshComponentStorage::add(EntityId entity, Bound3 const &bound, Mesh const *mesh, Material const *material, int flags)
 {
-  size_t index = 0;
+  auto index = insert(entity);
 
   if (flags & MeshComponent::Static)
   {
-    index = insert(entity);
+    // static rows stay ahead of the dynamic rows
 
-    if (index > m_staticpartition)
-    {
-      for_each(m_data, [=](auto &v) { swap(v[index], v[m_staticpartition]); });
-
-      swap(m_index[data<0>(index).index()], m_index[entity.index()]);
+    swap_rows(index, m_staticpartition);
 
-      index = m_staticpartition;
-    }
+    index = m_staticpartition;
 
-    m_staticpartition = max(m_staticpartition, index + 1);
-  }
-  else
-  {
-    index = append(entity);
+    m_staticpartition += 1;
   }
 
   set_entity(index, entity);
@@ -68,7 +59,49 @@ void MeshComponentStorage::add(EntityId entity, Bound3 const &bound, Mesh const
 
   if (flags & MeshComponent::Static)
   {
-    m_tree.insert(MeshIndex{ index, this });
+    m_tree.insert(MeshIndex{ entity, this });
+  }
+}
+
+
+///////////////////////// MeshStorage::add //////////////////////////////////
+void MeshComponentStorage::add(EntityId const *entities, size_t count, Mesh const * const *meshes, Material const * const *materials, int flags)
+{
+  auto transformstorage = m_scene->system<TransformComponentStorage>();
+
+  if ((flags & MeshComponent::Static) && m_staticpartition != size())
+  {
+    // static rows must stay ahead of the dynamic rows
+
+    for(size_t i = 0; i < count; ++i)
+    {
+      add(entities[i], transformstorage->get(entities[i]).world() * meshes[i]->bound, meshes[i], materials[i], flags);
+    }
+
+    return;
+  }
+
+  auto index = append(entities, count);
+
+  for(size_t i = 0; i < count; ++i, ++index)
+  {
+    assert(transformstorage->has(entities[i]));
+
+    set_entity(index, entities[i]);
+    set_flags(index, flags);
+    set_bound(index, transformstorage->get(entities[i]).world() * meshes[i]->bound);
+    set_mesh(index, meshes[i]);
+    set_material(index, materials[i]);
+
+    if (flags & MeshComponent::Static)
+    {
+      m_tree.insert(MeshIndex{ entities[i], this });
+    }
+  }
+
+  if (flags & MeshComponent::Static)
+  {
+    m_staticpartition = size();
   }
 }
 
@@ -76,26 +109,24 @@ void MeshComponentStorage::add(EntityId entity, Bound3 const &bound, Mesh const
 ///////////////////////// MeshStorage::remove ///////////////////////////////
 void MeshComponentStorage::remove(EntityId entity)
 {
+  if (!has(entity))
+    return;
+
   auto index = m_index[entity.index()];
 
   if (index < m_staticpartition)
   {
-    m_tree.remove(MeshIndex{ index, this });
-
-    for_each(m_data, [=](auto &v) { v[index] = {}; });
+    m_tree.remove(MeshIndex{ entity, this });
 
-    m_freeslots.push_back(index);
-  }
-  else
-  {
-    for_each(m_data, [=](auto &v) { swap(v[index], v[v.size()-1]); });
+    // close the hole with the last static row, leaving it at the front of
+    // the dynamic rows for the swap and pop below
 
-    for_each(m_data, [](auto &v) { v.resize(v.size()-1); });
+    swap_rows(index, m_staticpartition - 1);
 
-    m_index[data<0>(index).index()] = index;
+    m_staticpartition -= 1;
   }
 
-  m_index[entity.index()] = 0;
+  DenseStorage::remove(entity);
 }
 
 
@@ -104,6 +135,17 @@ void MeshComponentStorage::update_mesh_bounds()
 {
   auto transformstorage = m_scene->system<TransformComponentStorage>();
 
+  if (4*m_moves > size())
+  {
+    // removes have moved a quarter of the rows out of entity order, restore
+    // it (within each partition) to keep the transform lookups in order
+
+    sort(1, m_staticpartition);
+    sort(m_staticpartition, size());
+
+    m_moves = 0;
+  }
+
   for(size_t index = m_staticpartition; index < size(); ++index)
   {
     assert(transformstorage->has(entity(index)));
@@ -137,8 +179,8 @@ void Scene::initialise_component_storage<MeshComponent>()
 //|--------------------------------------------------------------------------
 
 ///////////////////////// MeshComponent::Constructor ////////////////////////
-MeshComponent::MeshComponent(size_t index, MeshComponentStorage *storage)
-  : index(index),
+MeshComponent::MeshComponent(Scene::EntityId entity, MeshComponentStorage *storage)
+  : entity(entity),
     storage(storage)
 {
 }
@@ -161,7 +203,7 @@ MeshComponent Scene::add_component<MeshComponent>(Scene::EntityId entity, Mesh c
 
   storage->add(entity, bound, mesh, material, flags);
 
-  return { storage->index(entity), storage };
+  return { entity, storage };
 }
 
 template<>
@@ -171,6 +213,16 @@ MeshComponent Scene::add_component<MeshComponent>(Scene::EntityId entity, Mesh c
 }
 
 
+///////////////////////// Scene::add_components /////////////////////////////
+template<>
+void Scene::add_components<MeshComponent>(Scene::EntityId const *entities, size_t count, Mesh const * const *meshes, Material const * const *materials, int flags)
+{
+  assert(system<TransformComponentStorage>());
+
+  system<MeshComponentStorage>()->add(entities, count, meshes, materials, flags);
+}
+
+
 ///////////////////////// Scene::remove_component ///////////////////////////
 template<>
 void Scene::remove_component<MeshComponent>(Scene::EntityId entity)
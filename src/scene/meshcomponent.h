@@ -18,7 +18,7 @@
 //|---------------------- MeshComponentStorage ------------------------------
 //|--------------------------------------------------------------------------
 
-class MeshComponentStorage : public DefaultStorage<Scene::EntityId, int, lml::Bound3, Mesh const *, Material const *>
+class MeshComponentStorage : public DenseStorage<Scene::EntityId, int, lml::Bound3, Mesh const *, Material const *>
 {
   public:
     MeshComponentStorage(Scene *scene, StackAllocator<> allocator);
@@ -26,38 +26,40 @@ class MeshComponentStorage : public DefaultStorage<Scene::EntityId, int, lml::Bo
     template<typename Component = class MeshComponent>
     Component get(EntityId entity)
     {
-      return { this->index(entity), this };
+      return { entity, this };
     }
 
     void update_mesh_bounds();
 
   public:
 
+    // tree entries hold the entity, static rows move as others are removed
+
     struct MeshIndex
     {
       operator EntityId() const
       {
-        return storage->data<0>(index);
+        return entity;
       }
 
       lml::Bound3 const &box() const
       {
-        return storage->data<2>(index);
+        return storage->data<2>(storage->index(entity));
       }
 
       friend bool operator ==(MeshIndex const &lhs, MeshIndex const &rhs)
       {
-        return lhs.index == rhs.index;
+        return lhs.entity == rhs.entity;
       }
 
-      size_t index;
+      EntityId entity;
       MeshComponentStorage *storage;
     };
 
     template<typename Component = class MeshComponent>
     Component get(MeshIndex const &index)
     {
-      return { index.index, this };
+      return { index.entity, this };
     }
 
     typedef leap::lml::RTree::basic_rtree<MeshIndex, 3, leap::lml::RTree::box<MeshIndex>, StackAllocatorWithFreelist<>>::const_iterator tree_iterator;
@@ -91,6 +93,7 @@ class MeshComponentStorage : public DefaultStorage<Scene::EntityId, int, lml::Bo
     void clear() override;
 
     void add(EntityId entity, lml::Bound3 const &bound, Mesh const *mesh, Material const *material, int flags);
+    void add(EntityId const *entities, size_t count, Mesh const * const *meshes, Material const * const *materials, int flags);
 
     void remove(EntityId entity) override;
 
@@ -126,21 +129,24 @@ class MeshComponent
 
   public:
     friend MeshComponent Scene::add_component<MeshComponent>(Scene::EntityId entity, Mesh const *mesh, Material const *material, int flags);
+    friend void Scene::add_components<MeshComponent>(Scene::EntityId const *entities, size_t count, Mesh const * const *meshes, Material const * const *materials, int flags);
     friend MeshComponent Scene::get_component<MeshComponent>(Scene::EntityId entity);
 
   public:
     MeshComponent() = default;
-    MeshComponent(size_t index, MeshComponentStorage *storage);
+    MeshComponent(Scene::EntityId entity, MeshComponentStorage *storage);
 
-    int flags() const { return storage->flags(index); }
+    int flags() const { return storage->flags(index()); }
 
-    lml::Bound3 const &bound() const { return storage->bound(index); }
+    lml::Bound3 const &bound() const { return storage->bound(index()); }
 
-    Mesh const *mesh() const { return storage->mesh(index); }
-    Material const *material() const { return storage->material(index); }
+    Mesh const *mesh() const { return storage->mesh(index()); }
+    Material const *material() const { return storage->material(index()); }
 
   protected:
 
-    size_t index;
+    size_t index() const { return storage->index(entity); }
+
+    Scene::EntityId entity;
     MeshComponentStorage *storage;
 };
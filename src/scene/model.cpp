@@ -14,6 +14,12 @@
 using namespace std;
 using namespace lml;
 
+namespace
+{
+  const size_t InstanceBatch = 256;
+}
+
+
 //|---------------------- Model ---------------------------------------------
 //|--------------------------------------------------------------------------
 
@@ -122,16 +128,23 @@ Scene::EntityId Model::add_instance(Transform const &transform, size_t mesh, siz
 {
   auto instance = m_scene->create<Entity>();
 
+  add_instance(instance, transform, mesh, material, flags);
+
+  dependants.push_back(instance);
+
+  return instance;
+}
+
+
+///////////////////////// Model::add_instance ///////////////////////////////
+void Model::add_instance(Scene::EntityId instance, Transform const &transform, size_t mesh, size_t material, int flags)
+{
   m_scene->add_component<TransformComponent>(instance, m_scene->get_component<TransformComponent>(id), transform);
 
   if (meshes[mesh] && materials[material])
   {
     m_scene->add_component<MeshComponent>(instance, meshes[mesh], materials[material], flags);
   }
-
-  dependants.push_back(instance);
-
-  return instance;
 }
 
 
@@ -205,11 +218,46 @@ bool Model::load(DatumPlatform::PlatformInterface &platform, ResourceManager *re
     meshes[i] = resources->create<Mesh>(assets->find(asset->id + meshtable[i].mesh));
   }
 
-  for(int i = 0; i < asset->instancecount; ++i)
+  auto instances = dependants.size();
+
+  dependants.resize(instances + asset->instancecount);
+
+  m_scene->create(asset->instancecount, dependants.data() + instances);
+
+  m_scene->system<TransformComponentStorage>()->reserve(asset->instancecount);
+  m_scene->system<MeshComponentStorage>()->reserve(asset->instancecount);
+
+  auto parent = m_scene->get_component<TransformComponent>(id);
+
+  for(int i = 0; i < asset->instancecount; i += InstanceBatch)
   {
-    auto transform =  Transform{ { instancetable[i].transform[0], instancetable[i].transform[1], instancetable[i].transform[2], instancetable[i].transform[3] }, { instancetable[i].transform[4], instancetable[i].transform[5], instancetable[i].transform[6], instancetable[i].transform[7] } };
+    Transform locals[InstanceBatch];
+    Scene::EntityId meshentities[InstanceBatch];
+    Mesh const *meshbatch[InstanceBatch];
+    Material const *materialbatch[InstanceBatch];
+
+    size_t count = min(size_t(asset->instancecount - i), size_t(InstanceBatch));
+    size_t meshcount = 0;
+
+    for(size_t k = 0; k < count; ++k)
+    {
+      auto &instance = instancetable[i + k];
+
+      locals[k] = Transform{ { instance.transform[0], instance.transform[1], instance.transform[2], instance.transform[3] }, { instance.transform[4], instance.transform[5], instance.transform[6], instance.transform[7] } };
+
+      if (meshes[instance.mesh] && materials[instance.material])
+      {
+        meshentities[meshcount] = dependants[instances + i + k];
+        meshbatch[meshcount] = meshes[instance.mesh];
+        materialbatch[meshcount] = materials[instance.material];
+
+        ++meshcount;
+      }
+    }
+
+    m_scene->add_components<TransformComponent>(dependants.data() + instances + i, count, parent, static_cast<Transform const *>(locals));
 
-    add_instance(transform, instancetable[i].mesh, instancetable[i].material, MeshComponent::Visible | MeshComponent::Static);
+    m_scene->add_components<MeshComponent>(meshentities, meshcount, static_cast<Mesh const * const *>(meshbatch), static_cast<Material const * const *>(materialbatch), MeshComponent::Visible | MeshComponent::Static);
   }
 
   return true;
@@ -44,6 +44,10 @@ class Model : public Entity
       return typeid(*this);
     }
 
+  private:
+
+    void add_instance(Scene::EntityId instance, lml::Transform const &transform, size_t mesh, size_t material, int flags);
+
   private:
 
     Scene::EntityId id;
@@ -19,9 +19,12 @@ using namespace leap;
 
 ///////////////////////// NameComponentStorage::Constructor /////////////////
 NameComponentStorage::NameComponentStorage(Scene *scene, StackAllocator<> allocator)
-  : DefaultStorage(scene, allocator),
-    m_names(allocator)
+  : DenseStorage(scene, allocator),
+    m_names(allocator),
+    m_buckets(4096, Bucket{}, allocator)
 {
+  m_count = 0;
+
   m_names.reserve(16384);
 }
 
@@ -31,16 +34,46 @@ void NameComponentStorage::clear()
 {
   m_names.clear();
 
-  DefaultStorage::clear();
+  fill(m_buckets.begin(), m_buckets.end(), Bucket{});
+
+  m_count = 0;
+
+  DenseStorage::clear();
+}
+
+
+///////////////////////// NameComponentStorage::hash ////////////////////////
+uint32_t NameComponentStorage::hash(const char *name)
+{
+  uint32_t result = 2166136261;
+
+  for(auto ch = name; *ch != 0; ++ch)
+  {
+    result = (result ^ uint32_t(std::tolower(*ch))) * 16777619;
+  }
+
+  return result;
 }
 
 
 ///////////////////////// NameComponentStorage::add /////////////////////////
 void NameComponentStorage::add(EntityId entity, const char *name)
 {
-  insert(entity);
+  auto index = insert(entity);
+
+  store(index, name);
+}
+
+
+///////////////////////// NameComponentStorage::remove //////////////////////
+void NameComponentStorage::remove(EntityId entity)
+{
+  if (has(entity))
+  {
+    remove_bucket(entity, data<2>(index(entity)));
 
-  set_name(entity, name);
+    DenseStorage::remove(entity);
+  }
 }
 
 
@@ -51,22 +84,106 @@ void NameComponentStorage::set_name(EntityId entity, const char *name)
 
   auto index = this->index(entity);
 
+  remove_bucket(entity, data<2>(index));
+
+  store(index, name);
+}
+
+
+///////////////////////// NameComponentStorage::store ///////////////////////
+void NameComponentStorage::store(size_t index, const char *name)
+{
+  auto hash = this->hash(name);
+
   data<1>(index) = m_names.size();
+  data<2>(index) = hash;
 
   m_names.insert(m_names.end(), name, name + strlen(name) + 1);
+
+  if (2*(m_count + 1) > m_buckets.size())
+  {
+    decltype(m_buckets) buckets(2*m_buckets.size(), Bucket{}, m_buckets.get_allocator());
+
+    swap(m_buckets, buckets);
+
+    m_count = 0;
+
+    for(auto &bucket : buckets)
+    {
+      if (bucket.entity)
+        insert_bucket(bucket);
+    }
+  }
+
+  insert_bucket({ hash, data<0>(index) });
+}
+
+
+///////////////////////// NameComponentStorage::insert_bucket ///////////////
+void NameComponentStorage::insert_bucket(Bucket const &bucket)
+{
+  auto mask = m_buckets.size() - 1;
+
+  auto i = bucket.hash & mask;
+
+  while (m_buckets[i].entity)
+    i = (i + 1) & mask;
+
+  m_buckets[i] = bucket;
+
+  m_count += 1;
+}
+
+
+///////////////////////// NameComponentStorage::remove_bucket ///////////////
+void NameComponentStorage::remove_bucket(EntityId entity, uint32_t hash)
+{
+  auto mask = m_buckets.size() - 1;
+
+  auto i = hash & mask;
+
+  while (m_buckets[i].entity != entity)
+    i = (i + 1) & mask;
+
+  // backward shift the rest of the cluster to keep probe chains unbroken
+
+  for(auto j = (i + 1) & mask; m_buckets[j].entity; j = (j + 1) & mask)
+  {
+    auto k = m_buckets[j].hash & mask;
+
+    if ((i < j) ? (i < k && k <= j) : (i < k || k <= j))
+      continue;
+
+    m_buckets[i] = m_buckets[j];
+
+    i = j;
+  }
+
+  m_buckets[i] = {};
+
+  m_count -= 1;
 }
 
 
 ///////////////////////// NameComponentStorage::find ////////////////////////
 Scene::EntityId NameComponentStorage::find(const char *name) const
 {
-  for(size_t index = 1; index < size(); ++index)
+  return find(name, hash(name));
+}
+
+
+///////////////////////// NameComponentStorage::find ////////////////////////
+Scene::EntityId NameComponentStorage::find(const char *name, uint32_t hash) const
+{
+  auto mask = m_buckets.size() - 1;
+
+  for(auto i = hash & mask; m_buckets[i].entity; i = (i + 1) & mask)
   {
-    if (data<0>(index))
+    if (m_buckets[i].hash == hash)
     {
       auto str1 = name;
-      auto str2 = m_names.data() + data<1>(index);
-      
+      auto str2 = this->name(m_buckets[i].entity);
+
       while (std::tolower(*str1) == std::tolower(*str2) && *str1 != 0)
       {
         ++str1;
@@ -74,7 +191,7 @@ Scene::EntityId NameComponentStorage::find(const char *name) const
       }
 
       if (std::tolower(*str2) - std::tolower(*str1) == 0)
-        return data<0>(index);
+        return m_buckets[i].entity;
     }
   }
 
@@ -14,15 +14,19 @@
 //|---------------------- NameComponentStorage ------------------------------
 //|--------------------------------------------------------------------------
 
-class NameComponentStorage : public DefaultStorage<Scene::EntityId, size_t>
+class NameComponentStorage : public DenseStorage<Scene::EntityId, size_t, uint32_t>
 {
   public:
     NameComponentStorage(Scene *scene, StackAllocator<> allocator);
 
     const char *name(EntityId entity) const { return m_names.data() + data<1>(index(entity)); }
 
-    // linear search
+    // case insensitive name hash
+    static uint32_t hash(const char *name);
+
+    // hashed search
     EntityId find(const char *name) const;
+    EntityId find(const char *name, uint32_t hash) const;
 
     template<typename Component = class NameComponent>
     Component get(EntityId entity)
@@ -36,10 +40,30 @@ class NameComponentStorage : public DefaultStorage<Scene::EntityId, size_t>
 
     void add(EntityId entity, const char *name);
 
+    void remove(EntityId entity) override;
+
     void set_name(EntityId entity, const char *name);
 
     std::vector<char, StackAllocator<char>> m_names;
 
+  protected:
+
+    struct Bucket
+    {
+      uint32_t hash;
+      EntityId entity;
+    };
+
+    void store(size_t index, const char *name);
+
+    void insert_bucket(Bucket const &bucket);
+    void remove_bucket(EntityId entity, uint32_t hash);
+
+    size_t m_count;
+
+    // sized up front, a regrow strands the old table in the arena
+    std::vector<Bucket, StackAllocator<Bucket>> m_buckets;
+
     friend class Scene;
     friend class NameComponent;
 };
@@ -17,7 +17,7 @@ using namespace lml;
 
 ///////////////////////// ParticleSystemStorage::Constructor ////////////////
 ParticleSystemComponentStorage::ParticleSystemComponentStorage(Scene *scene, StackAllocator<> allocator)
-  : DefaultStorage(scene, allocator),
+  : DenseStorage(scene, allocator),
     m_allocator(allocator, m_freelist)
 {
 }
@@ -43,7 +43,7 @@ void ParticleSystemComponentStorage::remove(EntityId entity)
 
   system(index)->destroy(instance(index));
 
-  DefaultStorage::remove(entity);
+  DenseStorage::remove(entity);
 }
 
 
@@ -103,8 +103,8 @@ void Scene::initialise_component_storage<ParticleSystemComponent>()
 //|--------------------------------------------------------------------------
 
 ///////////////////////// ParticleSystemComponent::Constructor //////////////
-ParticleSystemComponent::ParticleSystemComponent(size_t index, ParticleSystemComponentStorage *storage)
-  : index(index),
+ParticleSystemComponent::ParticleSystemComponent(Scene::EntityId entity, ParticleSystemComponentStorage *storage)
+  : entity(entity),
     storage(storage)
 {
 }
@@ -127,7 +127,7 @@ ParticleSystemComponent Scene::add_component<ParticleSystemComponent>(Scene::Ent
 
   storage->add(entity, bound, particlesystem, flags);
 
-  return { storage->index(entity), storage };
+  return { entity, storage };
 }
 
 template<>
@@ -17,7 +17,7 @@
 //|---------------------- ParticleSystemComponentStorage --------------------
 //|--------------------------------------------------------------------------
 
-class ParticleSystemComponentStorage : public DefaultStorage<Scene::EntityId, int, lml::Bound3, ParticleSystem const *, ParticleSystem::Instance *>
+class ParticleSystemComponentStorage : public DenseStorage<Scene::EntityId, int, lml::Bound3, ParticleSystem const *, ParticleSystem::Instance *>
 {
   public:
     ParticleSystemComponentStorage(Scene *scene, StackAllocator<> allocator);
@@ -25,7 +25,7 @@ class ParticleSystemComponentStorage : public DefaultStorage<Scene::EntityId, in
     template<typename Component = class ParticleSystemComponent>
     Component get(EntityId entity)
     {
-      return { this->index(entity), this };
+      return { entity, this };
     }
 
     void update_particlesystem_bounds();
@@ -81,17 +81,19 @@ class ParticleSystemComponent
 
   public:
     ParticleSystemComponent() = default;
-    ParticleSystemComponent(size_t index, ParticleSystemComponentStorage *storage);
+    ParticleSystemComponent(Scene::EntityId entity, ParticleSystemComponentStorage *storage);
 
-    int flags() const { return storage->flags(index); }
+    int flags() const { return storage->flags(index()); }
 
-    lml::Bound3 const &bound() const { return storage->bound(index); }
+    lml::Bound3 const &bound() const { return storage->bound(index()); }
 
-    ParticleSystem const *system() const { return storage->system(index); }
-    ParticleSystem::Instance *instance() const { return storage->instance(index); }
+    ParticleSystem const *system() const { return storage->system(index()); }
+    ParticleSystem::Instance *instance() const { return storage->instance(index()); }
 
   protected:
 
-    size_t index;
+    size_t index() const { return storage->index(entity); }
+
+    Scene::EntityId entity;
     ParticleSystemComponentStorage *storage;
 };
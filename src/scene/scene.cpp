@@ -21,9 +21,11 @@ Scene::Scene(allocator_type const &allocator)
   : m_allocator(allocator, m_freelist),
     m_systems(allocator),
     m_slots(allocator),
-    m_freeslots(allocator)
+    m_freeslots(allocator),
+    m_queries(allocator)
 {
   m_systems.reserve(128);
+  m_queries.reserve(128);
 
   clear();
 }
@@ -45,17 +47,26 @@ void Scene::clear()
 
       if (slot.bytes != 0)
       {
-        m_freelist.release(slot.entity, slot.bytes);
+        deallocate(&m_freelist, slot.entity, slot.bytes);
       }
     }
   }
 
+  {
+    leap::threadlib::SyncLock lock(m_querylock);
+
+    for(auto &query : m_queries)
+    {
+      query.second->clear();
+    }
+  }
+
   m_slots.clear();
   m_freeslots.clear();
 
   m_slots.push_back({ 0, size_t(-1), nullptr });
 
-  RESOURCE_USE(EntitySlot, m_slots.size(), m_slots.capacity())
+  RESOURCE_USE(EntitySlot, m_slots.size(), m_slots.capacity());
 }
 
 
@@ -64,7 +75,7 @@ void Scene::reserve(size_t capacity)
 {
   m_slots.reserve(capacity);
 
-  RESOURCE_USE(EntitySlot, m_slots.size(), m_slots.capacity())
+  RESOURCE_USE(EntitySlot, m_slots.size(), m_slots.capacity());
 }
 
 
@@ -90,7 +101,7 @@ Scene::Slot *Scene::acquire_slot()
 
   slot->id = { ((slot->id.generation() + 1) << kIndexBits) + (slot - &m_slots.front()) };
 
-  RESOURCE_USE(EntitySlot, m_slots.size(), m_slots.capacity())
+  RESOURCE_USE(EntitySlot, m_slots.size(), m_slots.capacity());
 
   return slot;
 }
@@ -99,27 +110,149 @@ Scene::Slot *Scene::acquire_slot()
 ///////////////////////// Scene::destroy ////////////////////////////////////
 void Scene::destroy(Scene::EntityId entity)
 {
-  assert(get(entity) != nullptr);
+  destroy(&entity, 1);
+}
 
-  Slot *slot = &m_slots[entity.index()];
 
-  get(entity)->~Entity();
+///////////////////////// Scene::destroy ////////////////////////////////////
+void Scene::destroy(Scene::EntityId const *entities, size_t count)
+{
+  for(size_t i = 0; i < count; ++i)
+  {
+    assert(get(entities[i]) != nullptr);
 
-  if (slot->bytes != 0)
+    Slot *slot = &m_slots[entities[i].index()];
+
+    get(entities[i])->~Entity();
+
+    if (slot->bytes != 0)
+    {
+      deallocate(&m_freelist, slot->entity, slot->bytes);
+    }
+
+    slot->bytes = -1;
+    slot->entity = nullptr;
+
+    m_freeslots.push_back(entities[i].index());
+  }
+
+  for(auto &system : m_systems)
   {
-    m_freelist.release(slot->entity, slot->bytes);
+    system.second->destroy(entities, count);
   }
 
-  slot->bytes = -1;
-  slot->entity = nullptr;
+  for(size_t i = 0; i < count; ++i)
+  {
+    update_queries(entities[i]);
+  }
 
-  m_freeslots.push_back(entity.index());
+  RESOURCE_USE(EntitySlot, m_slots.size(), m_slots.capacity());
+}
 
-  for(auto &system : m_systems)
+
+///////////////////////// Scene::update_queries /////////////////////////////
+void Scene::update_queries(Scene::EntityId entity)
+{
+  leap::threadlib::SyncLock lock(m_querylock);
+
+  for(auto &entry : m_queries)
   {
-    system.second->remove(entity);
+    auto query = entry.second;
+
+    auto member = (entity.index() < query->positions.size() && query->positions[entity.index()] != 0);
+
+    if (query->match(this, entity))
+    {
+      if (!member)
+        query->insert(entity);
+    }
+    else
+    {
+      if (member)
+      {
+        query->remove(entity);
+
+        // compact once holes dominate, unless an iteration is live, in
+        // which case release_query compacts when the last one ends
+
+        if (query->iterating == 0 && 2*query->holes > query->entities.size())
+          query->compact();
+      }
+    }
   }
+}
 
-  RESOURCE_USE(EntitySlot, m_slots.size(), m_slots.capacity())
+
+///////////////////////// Scene::release_query //////////////////////////////
+void Scene::release_query(Scene::Query const *query) const
+{
+  leap::threadlib::SyncLock lock(m_querylock);
+
+  auto &entry = const_cast<Query&>(*query);
+
+  entry.iterating -= 1;
+
+  if (entry.iterating == 0 && 2*entry.holes > entry.entities.size())
+    entry.compact();
+}
+
+
+//|---------------------- Scene::Query --------------------------------------
+//|--------------------------------------------------------------------------
+
+///////////////////////// Query::Constructor ////////////////////////////////
+Scene::Query::Query(StackAllocatorWithFreelist<> const &allocator)
+  : entities(allocator),
+    positions(allocator)
+{
+  holes = 0;
+  iterating = 0;
+}
+
+
+///////////////////////// Query::insert /////////////////////////////////////
+void Scene::Query::insert(Scene::EntityId entity)
+{
+  positions.resize(max(positions.size(), entity.index()+1));
+
+  entities.push_back(entity);
+
+  positions[entity.index()] = entities.size();
+}
+
+
+///////////////////////// Query::remove /////////////////////////////////////
+void Scene::Query::remove(Scene::EntityId entity)
+{
+  // leave a hole rather than reorder, so removal during iteration is safe
+
+  entities[positions[entity.index()] - 1] = {};
+
+  positions[entity.index()] = 0;
+
+  holes += 1;
+}
+
+
+///////////////////////// Query::compact ////////////////////////////////////
+void Scene::Query::compact()
+{
+  entities.erase(remove_if(entities.begin(), entities.end(), [](EntityId entity) { return !entity; }), entities.end());
+
+  for(size_t i = 0; i < entities.size(); ++i)
+  {
+    positions[entities[i].index()] = i + 1;
+  }
+
+  holes = 0;
 }
 
+
+///////////////////////// Query::clear //////////////////////////////////////
+void Scene::Query::clear()
+{
+  entities.clear();
+  positions.clear();
+
+  holes = 0;
+}
@@ -10,6 +10,7 @@
 
 #include "datum.h"
 #include "datum/memory.h"
+#include <leap/threadcontrol.h>
 #include <iostream>
 #include <vector>
 #include <deque>
@@ -58,9 +59,15 @@ class Scene
     template<typename Entity, typename ...Args>
     EntityId load(DatumPlatform::PlatformInterface &platform, Args... args);
 
+    // create entities in bulk
+    void create(size_t count, EntityId *entities);
+
     // destroy entity
     void destroy(EntityId entity);
 
+    // destroy entities in bulk, children must be in the batch or already destroyed
+    void destroy(EntityId const *entities, size_t count);
+
     // access entity
     template<typename Entity = Entity>
     Entity const *get(EntityId entity) const
@@ -93,6 +100,10 @@ class Scene
     template<typename Component, typename ...Args>
     Component add_component(EntityId entity, Args... args);
 
+    // add components to a batch of entities as contiguous rows
+    template<typename Component, typename ...Args>
+    void add_components(EntityId const *entities, size_t count, Args... args);
+
     template<typename Component>
     void remove_component(EntityId entity);
 
@@ -117,32 +128,36 @@ class Scene
       return true;
     }
 
+  private:
+
+    struct Query;
+
   public:
 
     template<typename ...Components>
     class iterator
     {
       public:
-        explicit iterator(Scene const *scene, size_t index)
-          : index(index), scene(scene)
+        explicit iterator(Query const *query, size_t index)
+          : index(index), query(query)
         {
-          if (index != scene->m_slots.size() && (!scene->get(*this) || !scene->has_components<Components...>(*this)))
+          if (index != query->entities.size() && !query->entities[index])
             ++*this;
         }
 
         bool operator ==(iterator const &that) const { return index == that.index; }
         bool operator !=(iterator const &that) const { return index != that.index; }
 
-        operator EntityId() { return scene->m_slots[index].id; }
+        operator EntityId() { return query->entities[index]; }
 
-        EntityId const &operator *() const { return scene->m_slots[index].id; }
-        EntityId const *operator ->() const { return &scene->m_slots[index].id; }
+        EntityId const &operator *() const { return query->entities[index]; }
+        EntityId const *operator ->() const { return &query->entities[index]; }
 
         iterator &operator++()
         {
           ++index;
 
-          while (index != scene->m_slots.size() && (!scene->get(*this) || !scene->has_components<Components...>(*this)))
+          while (index != query->entities.size() && !query->entities[index])
             ++index;
 
           return *this;
@@ -151,23 +166,49 @@ class Scene
       private:
 
         size_t index;
-        Scene const *scene;
+        Query const *query;
     };
 
+    // live iteration range, holds its query uncompacted until destroyed
     template<typename Iterator>
     class iterator_pair : public std::pair<Iterator, Iterator>
     {
       public:
-        using std::pair<Iterator, Iterator>::pair;
+        iterator_pair(Iterator first, Iterator second, Scene const *scene, Query const *query)
+          : std::pair<Iterator, Iterator>(first, second), scene(scene), query(query)
+        {
+        }
+
+        iterator_pair(iterator_pair &&that)
+          : std::pair<Iterator, Iterator>(that), scene(that.scene), query(that.query)
+        {
+          that.query = nullptr;
+        }
+
+        ~iterator_pair()
+        {
+          if (query)
+            scene->release_query(query);
+        }
 
         Iterator begin() const { return this->first; }
         Iterator end() const { return this->second; }
+
+      private:
+
+        Scene const *scene;
+        Query const *query;
     };
 
+    // cached query, maintained as components are added and removed
+    // entities may be iterated from several threads, but scene mutation
+    // (create, destroy, add and remove component) is single threaded
     template<typename ...Components>
     iterator_pair<iterator<Components...>> entities() const
     {
-      return { iterator<Components...>(this, 0), iterator<Components...>(this, m_slots.size()) };
+      auto query = acquire_query<Components...>();
+
+      return { iterator<Components...>(query, 0), iterator<Components...>(query, query->entities.size()), this, query };
     }
 
   public:
@@ -188,7 +229,7 @@ class Scene
 
   private:
 
-    FreeList m_freelist;
+    ConcurrentFreeList m_freelist;
     StackAllocatorWithFreelist<> m_allocator;
 
     template<typename Entity, typename ...Args, std::enable_if_t<sizeof(Entity) == sizeof(Entity*)>* = nullptr>
@@ -199,6 +240,8 @@ class Scene
       slot->bytes = 0;
       new(&slot->entity) Entity(std::forward<Args>(args)...);
 
+      update_queries(slot->id);
+
       return slot->id;
     }
 
@@ -210,6 +253,8 @@ class Scene
       slot->bytes = sizeof(Entity);
       slot->entity = new(allocate<Entity>(m_allocator)) Entity(std::forward<Args>(args)...);
 
+      update_queries(slot->id);
+
       return slot->id;
     }
 
@@ -235,9 +280,69 @@ class Scene
     std::vector<Slot, StackAllocator<Slot>> m_slots;
 
     std::deque<size_t, StackAllocator<size_t>> m_freeslots;
+
+  private:
+
+    struct Query
+    {
+      Query(StackAllocatorWithFreelist<> const &allocator);
+
+      bool (*match)(Scene const *scene, EntityId entity);
+
+      void insert(EntityId entity);
+      void remove(EntityId entity);
+
+      void compact();
+      void clear();
+
+      size_t holes;
+
+      size_t iterating;
+
+      std::vector<EntityId, StackAllocatorWithFreelist<EntityId>> entities;
+      std::vector<size_t, StackAllocatorWithFreelist<size_t>> positions;
+    };
+
+    template<typename ...Components>
+    Query const *acquire_query() const;
+
+    void release_query(Query const *query) const;
+
+    void update_queries(EntityId entity);
+
+    mutable std::unordered_map<std::type_index, Query*, std::hash<std::type_index>, std::equal_to<>, StackAllocator<std::pair<const std::type_index, Query*>>> m_queries;
+
+    mutable leap::threadlib::SpinLock m_querylock;
 };
 
 
+///////////////////////// Scene::acquire_query //////////////////////////////
+template<typename ...Components>
+Scene::Query const *Scene::acquire_query() const
+{
+  leap::threadlib::SyncLock lock(m_querylock);
+
+  auto &query = m_queries[typeid(iterator<Components...>)];
+
+  if (!query)
+  {
+    query = new(allocate<Query>(m_allocator)) Query(m_allocator);
+
+    query->match = [](Scene const *scene, EntityId entity) { return scene->get(entity) && scene->has_components<Components...>(entity); };
+
+    for(auto &slot : m_slots)
+    {
+      if (query->match(this, slot.id))
+        query->insert(slot.id);
+    }
+  }
+
+  query->iterating += 1;
+
+  return query;
+}
+
+
 //////////////////////// Entity stream << ///////////////////////////////////
 inline std::ostream &operator <<(std::ostream &os, Scene::EntityId const &entity)
 {
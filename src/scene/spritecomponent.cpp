@@ -18,7 +18,7 @@ using namespace lml;
 
 ///////////////////////// SpriteStorage::Constructor ////////////////////////
 SpriteComponentStorage::SpriteComponentStorage(Scene *scene, StackAllocator<> allocator)
-  : DefaultStorage(scene, allocator)
+  : DenseStorage(scene, allocator)
 {
 }
 
@@ -49,8 +49,8 @@ void Scene::initialise_component_storage<SpriteComponent>()
 //|--------------------------------------------------------------------------
 
 ///////////////////////// SpriteComponent::Constructor //////////////////////
-SpriteComponent::SpriteComponent(size_t index, SpriteComponentStorage *storage)
-  : index(index),
+SpriteComponent::SpriteComponent(Scene::EntityId entity, SpriteComponentStorage *storage)
+  : entity(entity),
     storage(storage)
 {
 }
@@ -59,38 +59,38 @@ SpriteComponent::SpriteComponent(size_t index, SpriteComponentStorage *storage)
 ///////////////////////// SpriteComponent::set_size /////////////////////////
 void SpriteComponent::set_size(float size)
 {
-  storage->set_size(index, size);
+  storage->set_size(index(), size);
 }
 
 
 ///////////////////////// SpriteComponent::set_layer ////////////////////////
 void SpriteComponent::set_layer(float layer)
 {
-  storage->set_layer(index, layer);
+  storage->set_layer(index(), layer);
 }
 
 
 ///////////////////////// SpriteComponent::set_sprite ///////////////////////
 void SpriteComponent::set_sprite(Sprite const *sprite, float size)
 {
-  storage->set_sprite(index, sprite);
-  storage->set_size(index, size);
+  storage->set_sprite(index(), sprite);
+  storage->set_size(index(), size);
 }
 
 
 ///////////////////////// SpriteComponent::set_sprite ///////////////////////
 void SpriteComponent::set_sprite(Sprite const *sprite, float size, Color4 const &tint)
 {
-  storage->set_sprite(index, sprite);
-  storage->set_size(index, size);
-  storage->set_tint(index, tint);
+  storage->set_sprite(index(), sprite);
+  storage->set_size(index(), size);
+  storage->set_tint(index(), tint);
 }
 
 
 ///////////////////////// SpriteComponent::set_tint /////////////////////////
 void SpriteComponent::set_tint(Color4 const &tint)
 {
-  storage->set_tint(index, tint);
+  storage->set_tint(index(), tint);
 }
 
 
@@ -106,7 +106,7 @@ SpriteComponent Scene::add_component<SpriteComponent>(Scene::EntityId entity, Sp
 
   storage->add(entity, sprite, size, 0.0f, tint, flags);
 
-  return { storage->index(entity), storage };
+  return { entity, storage };
 }
 
 template<>
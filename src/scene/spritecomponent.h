@@ -16,7 +16,7 @@
 //|---------------------- SpriteComponentStorage ----------------------------
 //|--------------------------------------------------------------------------
 
-class SpriteComponentStorage  : public DefaultStorage<Scene::EntityId, int, Sprite const *, float, float, lml::Color4>
+class SpriteComponentStorage  : public DenseStorage<Scene::EntityId, int, Sprite const *, float, float, lml::Color4>
 {
   public:
     SpriteComponentStorage(Scene *scene, StackAllocator<> allocator);
@@ -24,7 +24,7 @@ class SpriteComponentStorage  : public DefaultStorage<Scene::EntityId, int, Spri
     template<typename Component = class SpriteComponent>
     Component get(EntityId entity)
     {
-      return { this->index(entity), this };
+      return { entity, this };
     }
 
   protected:
@@ -71,15 +71,15 @@ class SpriteComponent
 
   public:
     SpriteComponent() = default;
-    SpriteComponent(size_t index, SpriteComponentStorage *storage);
+    SpriteComponent(Scene::EntityId entity, SpriteComponentStorage *storage);
 
-    long flags() const { return storage->flags(index); }
+    long flags() const { return storage->flags(index()); }
 
-    Sprite const *sprite() const { return storage->sprite(index); }
+    Sprite const *sprite() const { return storage->sprite(index()); }
 
-    float size() const { return storage->size(index); }
-    float layer() const { return storage->layer(index); }
-    lml::Color4 const &tint() const { return storage->tint(index); }
+    float size() const { return storage->size(index()); }
+    float layer() const { return storage->layer(index()); }
+    lml::Color4 const &tint() const { return storage->tint(index()); }
 
     lml::Rect2 bound() const { return lml::Rect2(-sprite()->pivot, lml::Vec2(size() * sprite()->aspect, size()) - sprite()->pivot); }
 
@@ -91,6 +91,8 @@ class SpriteComponent
 
   private:
 
-    size_t index;
+    size_t index() const { return storage->index(entity); }
+
+    Scene::EntityId entity;
     SpriteComponentStorage *storage;
 };
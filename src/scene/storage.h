@@ -18,6 +18,18 @@
 
 class Storage
 {
+  public:
+
+    template<typename Iterator>
+    class iterator_pair : public std::pair<Iterator, Iterator>
+    {
+      public:
+        using std::pair<Iterator, Iterator>::pair;
+
+        Iterator begin() const { return this->first; }
+        Iterator end() const { return this->second; }
+    };
+
   protected:
     Storage(Scene *scene);
     virtual ~Storage();
@@ -26,6 +38,26 @@ class Storage
 
     virtual void remove(Scene::EntityId entity) = 0;
 
+    // remove the components of a batch of entities being destroyed
+    virtual void destroy(Scene::EntityId const *entities, size_t count);
+
+    void update_queries(Scene::EntityId entity) { m_scene->update_queries(entity); }
+
+  protected:
+
+    template<typename Tuple, typename Fn, size_t... Indices>
+    void for_each(Tuple &&tuple, Fn &&f, std::index_sequence<Indices...>)
+    {
+      using sink = int[];
+      (void)(sink{ ((void)f(std::get<Indices>(std::forward<Tuple>(tuple))), 0)... });
+    }
+
+    template<typename Tuple, typename Fn>
+    void for_each(Tuple &&tuple, Fn &&f)
+    {
+      for_each(std::forward<Tuple>(tuple), std::forward<Fn>(f), std::make_index_sequence<std::tuple_size<std::decay_t<Tuple>>::value>());
+    }
+
   protected:
 
     Scene *m_scene;
@@ -46,6 +78,16 @@ inline Storage::~Storage()
 }
 
 
+///////////////////////// Storage::destroy //////////////////////////////////
+inline void Storage::destroy(Scene::EntityId const *entities, size_t count)
+{
+  for(size_t i = 0; i < count; ++i)
+  {
+    remove(entities[i]);
+  }
+}
+
+
 //|---------------------- DefaultStorage ------------------------------------
 //|--------------------------------------------------------------------------
 
@@ -66,6 +108,9 @@ class DefaultStorage : public Storage
 
     bool has(EntityId entity) const;
 
+    // make room for count more components
+    void reserve(size_t count);
+
   public:
 
     class iterator
@@ -100,16 +145,6 @@ class DefaultStorage : public Storage
         DefaultStorage const *storage;
     };
 
-    template<typename Iterator>
-    class iterator_pair : public std::pair<Iterator, Iterator>
-    {
-      public:
-        using std::pair<Iterator, Iterator>::pair;
-
-        Iterator begin() const { return this->first; }
-        Iterator end() const { return this->second; }
-    };
-
     iterator_pair<iterator> entities() const
     {
       return { iterator(this, 0), iterator(this, this->size()) };
@@ -140,22 +175,10 @@ class DefaultStorage : public Storage
     size_t insert(EntityId entity);
     size_t append(EntityId entity);
 
-    virtual void remove(EntityId entity) override;
-
-  protected:
-
-    template<typename Tuple, typename Fn, size_t... Indices>
-    void for_each(Tuple &&tuple, Fn &&f, std::index_sequence<Indices...>)
-    {
-      using sink = int[];
-      (void)(sink{ ((void)f(std::get<Indices>(std::forward<Tuple>(tuple))), 0)... });
-    }
+    // append count contiguous rows, returns the first
+    size_t append(EntityId const *entities, size_t count);
 
-    template<typename Tuple, typename Fn>
-    void for_each(Tuple &&tuple, Fn &&f)
-    {
-      for_each(std::forward<Tuple>(tuple), std::forward<Fn>(f), std::make_index_sequence<std::tuple_size<std::decay_t<Tuple>>::value>());
-    }
+    virtual void remove(EntityId entity) override;
 
   protected:
 
@@ -196,6 +219,14 @@ void DefaultStorage<Types...>::clear()
 }
 
 
+///////////////////////// DefaultStorage::reserve ///////////////////////////
+template<typename ...Types>
+void DefaultStorage<Types...>::reserve(size_t count)
+{
+  for_each(m_data, [=](auto &v) { v.reserve(v.size() + count); });
+}
+
+
 ///////////////////////// DefaultStorage::has ///////////////////////////////
 template<typename ...Types>
 bool DefaultStorage<Types...>::has(EntityId entity) const
@@ -239,6 +270,8 @@ size_t DefaultStorage<Types...>::insert(EntityId entity)
 
   m_index[entity.index()] = index;
 
+  update_queries(entity);
+
   return index;
 }
 
@@ -257,6 +290,31 @@ size_t DefaultStorage<Types...>::append(EntityId entity)
 
   m_index[entity.index()] = index;
 
+  update_queries(entity);
+
+  return index;
+}
+
+
+///////////////////////// DefaultStorage::append ////////////////////////////
+template<typename ...Types>
+size_t DefaultStorage<Types...>::append(EntityId const *entities, size_t count)
+{
+  size_t index = size();
+
+  for_each(m_data, [=](auto &v) { v.resize(v.size()+count); });
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    assert(!has(entities[i]));
+
+    m_index.resize(std::max(m_index.size(), entities[i].index()+1));
+
+    m_index[entities[i].index()] = index + i;
+
+    update_queries(entities[i]);
+  }
+
   return index;
 }
 
@@ -274,5 +332,293 @@ void DefaultStorage<Types...>::remove(EntityId entity)
     m_freeslots.push_back(index);
 
     m_index[entity.index()] = 0;
+
+    update_queries(entity);
+  }
+}
+
+
+
+//|---------------------- DenseStorage --------------------------------------
+//|--------------------------------------------------------------------------
+
+// Sparse set storage. Rows are kept packed by moving the last row into the
+// hole on remove. The first column must hold the owning EntityId. Row
+// indices are not stable across removes or sort; components hold entities.
+
+template<typename ...Types>
+class DenseStorage : public Storage
+{
+  protected:
+
+    typedef StackAllocator<> allocator_type;
+
+    DenseStorage(Scene *scene, allocator_type const &allocator);
+
+    DenseStorage(DenseStorage const &) = delete;
+
+    static_assert(std::is_same<std::tuple_element_t<0, std::tuple<Types...>>, Scene::EntityId>::value, "first column must be EntityId");
+
+  public:
+
+    using EntityId = Scene::EntityId;
+
+    bool has(EntityId entity) const;
+
+    // make room for count more components
+    void reserve(size_t count);
+
+    // reorder rows into entity order, invalidates held row indices
+    void sort();
+
+  public:
+
+    // walks the rows from the back, so removing the current entity or one
+    // already visited (which moves an already visited row into the hole)
+    // neither skips nor repeats a row. Removing an entity not yet visited
+    // moves a visited row into it, which is then visited a second time.
+
+    class iterator
+    {
+      public:
+        explicit iterator(DenseStorage const *storage, size_t index)
+          : index(index), storage(storage)
+        {
+        }
+
+        bool operator ==(iterator const &that) const { return index == that.index; }
+        bool operator !=(iterator const &that) const { return index != that.index; }
+
+        EntityId const &operator *() const { return storage->data<0>(index); }
+        EntityId const *operator ->() const { return &storage->data<0>(index); }
+
+        iterator &operator++()
+        {
+          --index;
+
+          return *this;
+        }
+
+      private:
+
+        size_t index;
+        DenseStorage const *storage;
+    };
+
+    iterator_pair<iterator> entities() const
+    {
+      return { iterator(this, this->size() - 1), iterator(this, 0) };
+    }
+
+  protected:
+
+    size_t index(EntityId entity) const;
+
+    size_t size() const { return std::get<0>(m_data).size(); }
+
+    template<size_t typeindex>
+    auto &data(size_t index)
+    {
+      return std::get<typeindex>(m_data)[index];
+    }
+
+    template<size_t typeindex>
+    auto const &data(size_t index) const
+    {
+      return std::get<typeindex>(m_data)[index];
+    }
+
+  protected:
+
+    void clear() override;
+
+    size_t insert(EntityId entity);
+
+    // append count contiguous rows, returns the first
+    size_t append(EntityId const *entities, size_t count);
+
+    virtual void remove(EntityId entity) override;
+
+    void swap_rows(size_t i, size_t j);
+
+    // reorder rows [first, last) into entity order
+    void sort(size_t first, size_t last);
+
+  protected:
+
+    std::vector<size_t, StackAllocator<size_t>> m_index;
+
+    std::tuple<std::vector<Types, StackAllocator<Types>>...> m_data;
+
+    size_t m_moves;
+
+    friend class Scene;
+};
+
+
+//|---------------------- DenseStorage --------------------------------------
+//|--------------------------------------------------------------------------
+
+///////////////////////// DenseStorage::Constructor /////////////////////////
+template<typename ...Types>
+DenseStorage<Types...>::DenseStorage(Scene *scene, allocator_type const &allocator)
+  : Storage(scene),
+    m_index(allocator),
+    m_data(std::allocator_arg, allocator)
+{
+  clear();
+}
+
+
+///////////////////////// DenseStorage::clear ///////////////////////////////
+template<typename ...Types>
+void DenseStorage<Types...>::clear()
+{
+  m_index.clear();
+
+  for_each(m_data, [](auto &v) { v.resize(1); });
+
+  m_moves = 0;
+}
+
+
+///////////////////////// DenseStorage::reserve /////////////////////////////
+template<typename ...Types>
+void DenseStorage<Types...>::reserve(size_t count)
+{
+  for_each(m_data, [=](auto &v) { v.reserve(v.size() + count); });
+}
+
+
+///////////////////////// DenseStorage::has /////////////////////////////////
+template<typename ...Types>
+bool DenseStorage<Types...>::has(EntityId entity) const
+{
+  return (entity.index() < m_index.size()) && (m_index[entity.index()] != 0);
+}
+
+
+///////////////////////// DenseStorage::index ///////////////////////////////
+template<typename ...Types>
+size_t DenseStorage<Types...>::index(EntityId entity) const
+{
+  assert(has(entity));
+
+  return m_index[entity.index()];
+}
+
+
+///////////////////////// DenseStorage::insert //////////////////////////////
+template<typename ...Types>
+size_t DenseStorage<Types...>::insert(EntityId entity)
+{
+  assert(!has(entity));
+
+  size_t index = size();
+
+  for_each(m_data, [](auto &v) { v.resize(v.size()+1); });
+
+  data<0>(index) = entity;
+
+  m_index.resize(std::max(m_index.size(), entity.index()+1));
+
+  m_index[entity.index()] = index;
+
+  update_queries(entity);
+
+  return index;
+}
+
+
+///////////////////////// DenseStorage::append //////////////////////////////
+template<typename ...Types>
+size_t DenseStorage<Types...>::append(EntityId const *entities, size_t count)
+{
+  size_t index = size();
+
+  for_each(m_data, [=](auto &v) { v.resize(v.size()+count); });
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    assert(!has(entities[i]));
+
+    data<0>(index + i) = entities[i];
+
+    m_index.resize(std::max(m_index.size(), entities[i].index()+1));
+
+    m_index[entities[i].index()] = index + i;
+
+    update_queries(entities[i]);
+  }
+
+  return index;
+}
+
+
+///////////////////////// DenseStorage::remove //////////////////////////////
+template<typename ...Types>
+void DenseStorage<Types...>::remove(EntityId entity)
+{
+  if (has(entity))
+  {
+    auto index = m_index[entity.index()];
+
+    if (index != size() - 1)
+      m_moves += 1;
+
+    swap_rows(index, size() - 1);
+
+    for_each(m_data, [](auto &v) { v.pop_back(); });
+
+    m_index[entity.index()] = 0;
+
+    update_queries(entity);
+  }
+}
+
+
+///////////////////////// DenseStorage::swap_rows ///////////////////////////
+template<typename ...Types>
+void DenseStorage<Types...>::swap_rows(size_t i, size_t j)
+{
+  if (i != j)
+  {
+    using std::swap;
+
+    for_each(m_data, [=](auto &v) { swap(v[i], v[j]); });
+
+    m_index[data<0>(i).index()] = i;
+    m_index[data<0>(j).index()] = j;
+  }
+}
+
+
+///////////////////////// DenseStorage::sort ////////////////////////////////
+template<typename ...Types>
+void DenseStorage<Types...>::sort()
+{
+  sort(1, size());
+
+  m_moves = 0;
+}
+
+
+///////////////////////// DenseStorage::sort ////////////////////////////////
+template<typename ...Types>
+void DenseStorage<Types...>::sort(size_t first, size_t last)
+{
+  // reorder rows into entity slot order, in place. Each swap parks the
+  // displaced row further along the range, where it is picked up later
+
+  size_t row = first;
+
+  for(size_t i = 0; i < m_index.size(); ++i)
+  {
+    if (first <= m_index[i] && m_index[i] < last)
+    {
+      swap_rows(row, m_index[i]);
+
+      row += 1;
+    }
   }
 }
@@ -34,6 +34,30 @@ void TransformComponentStorage::add(EntityId entity)
 }
 
 
+///////////////////////// TransformStorage::add /////////////////////////////
+void TransformComponentStorage::add(EntityId const *entities, size_t count, size_t parentindex, Transform const *locals)
+{
+  auto index = append(entities, count);
+
+  for(size_t i = 0; i < count; ++i, ++index)
+  {
+    set_local(index, locals[i]);
+    set_world(index, parentindex ? world(parentindex) * locals[i] : locals[i]);
+    set_parent(index, parentindex);
+    set_firstchild(index, 0);
+    set_nextsibling(index, 0);
+    set_prevsibling(index, 0);
+
+    if (parentindex != 0)
+    {
+      set_nextsibling(index, firstchild(parentindex));
+      set_prevsibling(firstchild(parentindex), index);
+      set_firstchild(parentindex, index);
+    }
+  }
+}
+
+
 ///////////////////////// TransformStorage::remove //////////////////////////
 void TransformComponentStorage::remove(EntityId entity)
 {
@@ -52,6 +76,41 @@ void TransformComponentStorage::remove(EntityId entity)
 }
 
 
+///////////////////////// TransformStorage::destroy /////////////////////////
+void TransformComponentStorage::destroy(EntityId const *entities, size_t count)
+{
+  // unlink the whole batch first, so a parent is childless by the time it
+  // is removed regardless of where it sits in the batch
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    if (has(entities[i]))
+      detach(index(entities[i]));
+  }
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    if (has(entities[i]))
+      remove(entities[i]);
+  }
+}
+
+
+///////////////////////// TransformStorage::detach //////////////////////////
+void TransformComponentStorage::detach(size_t index)
+{
+  if (firstchild(parent(index)) == index)
+    set_firstchild(parent(index), nextsibling(index));
+
+  set_nextsibling(prevsibling(index), nextsibling(index));
+  set_prevsibling(nextsibling(index), prevsibling(index));
+
+  set_parent(index, 0);
+  set_nextsibling(index, 0);
+  set_prevsibling(index, 0);
+}
+
+
 ///////////////////////// TransformStorage::reparent ////////////////////////
 void TransformComponentStorage::reparent(size_t index, size_t parentindex)
 {
@@ -166,6 +225,18 @@ TransformComponent Scene::add_component<TransformComponent>(Scene::EntityId enti
 }
 
 
+///////////////////////// Scene::add_components /////////////////////////////
+template<>
+void Scene::add_components<TransformComponent>(Scene::EntityId const *entities, size_t count, TransformComponent parent, Transform const *locals)
+{
+  auto storage = system<TransformComponentStorage>();
+
+  assert(parent.storage == storage);
+
+  storage->add(entities, count, parent.index, locals);
+}
+
+
 ///////////////////////// Scene::remove_component ///////////////////////////
 template<>
 void Scene::remove_component<TransformComponent>(Scene::EntityId entity)
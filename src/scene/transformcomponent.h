@@ -45,9 +45,14 @@ class TransformComponentStorage : public DefaultStorage<lml::Transform, lml::Tra
   protected:
 
     void add(EntityId entity);
+    void add(EntityId const *entities, size_t count, size_t parentindex, lml::Transform const *locals);
 
     void remove(EntityId entity) override;
 
+    void destroy(EntityId const *entities, size_t count) override;
+
+    void detach(size_t index);
+
     void reparent(size_t index, size_t parentindex);
 
     void update(size_t index);
@@ -66,6 +71,7 @@ class TransformComponent
     friend TransformComponent Scene::add_component<TransformComponent>(Scene::EntityId entity);
     friend TransformComponent Scene::add_component<TransformComponent>(Scene::EntityId entity, lml::Transform local);
     friend TransformComponent Scene::add_component<TransformComponent>(Scene::EntityId entity, TransformComponent parent, lml::Transform local);
+    friend void Scene::add_components<TransformComponent>(Scene::EntityId const *entities, size_t count, TransformComponent parent, lml::Transform const *locals);
     friend TransformComponent Scene::get_component<TransformComponent>(Scene::EntityId entity);
 
   public:
@@ -38,6 +38,7 @@ class Platform : public PlatformInterface
 
     handle_t open_handle(const char *identifier) override;
     size_t read_handle(handle_t handle, uint64_t position, void *buffer, size_t bytes) override;
+    void read_handle_async(handle_t handle, uint64_t position, void *buffer, size_t bytes, void (*callback)(PlatformInterface &, void*, size_t), void *userdata) override;
     void close_handle(handle_t handle) override;
 
     // cursor
@@ -51,6 +52,9 @@ class Platform : public PlatformInterface
     // work queue
 
     void submit_work(void (*func)(PlatformInterface &, void*, void*), void *ldata, void *rdata) override;
+    void submit_work(void (*func)(PlatformInterface &, void*, void*), void *ldata, void *rdata, WorkCounter *counter, WorkCounter *dependency) override;
+    void wait_work(WorkCounter *counter) override;
+    size_t work_threads() override;
 
     // misc
 
@@ -67,6 +71,8 @@ class Platform : public PlatformInterface
     RenderDevice m_renderdevice;
 
     WorkQueue m_workqueue;
+
+    IOQueue m_ioqueue;
 };
 
 
@@ -109,6 +115,13 @@ size_t Platform::read_handle(PlatformInterface::handle_t handle, uint64_t positi
 }
 
 
+///////////////////////// PlatformCore::read_handle_async ///////////////////
+void Platform::read_handle_async(PlatformInterface::handle_t handle, uint64_t position, void *buffer, size_t bytes, void (*callback)(PlatformInterface &, void*, size_t), void *userdata)
+{
+  m_ioqueue.read_async(m_workqueue, this, static_cast<FileHandle*>(handle), position, buffer, bytes, callback, userdata);
+}
+
+
 ///////////////////////// PlatformCore::close_handle ////////////////////////
 void Platform::close_handle(PlatformInterface::handle_t handle)
 {
@@ -154,7 +167,31 @@ void Platform::set_cursor_position(float x, float y)
 ///////////////////////// Platform::submit_work /////////////////////////////
 void Platform::submit_work(void (*func)(PlatformInterface &, void*, void*), void *ldata, void *rdata)
 {
-  m_workqueue.push([=]() { func(*this, ldata, rdata); });
+  m_workqueue.push(func, this, ldata, rdata);
+}
+
+
+///////////////////////// Platform::submit_work /////////////////////////////
+void Platform::submit_work(void (*func)(PlatformInterface &, void*, void*), void *ldata, void *rdata, WorkCounter *counter, WorkCounter *dependency)
+{
+  m_workqueue.push(func, this, ldata, rdata, counter, dependency);
+}
+
+
+///////////////////////// Platform::wait_work ///////////////////////////////
+void Platform::wait_work(WorkCounter *counter)
+{
+  m_workqueue.wait(counter);
+}
+
+
+///////////////////////// Platform::work_threads ////////////////////////////
+size_t Platform::work_threads()
+{
+  // thread indices are dense, the platform threads are the main and update
+  // threads, the workers and the io threads (which submit completions)
+
+  return 2 + m_workqueue.threads() + m_ioqueue.threads();
 }
 
 
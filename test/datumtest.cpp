@@ -5,6 +5,7 @@
 #include "datumtest.h"
 #include "fallback.h"
 #include "datum/debug.h"
+#include <chrono>
 
 using namespace std;
 using namespace lml;
@@ -47,14 +48,220 @@ namespace
     }
   }
 
+  ///////////////////////// verify_light_culling ///////////////////////////
+  [[maybe_unused]] void verify_light_culling(Camera const &camera)
+  {
+    // brute force reference : every sampled point of a light volume lies in
+    // its bound, and a light with any sampled point in view is never culled
+
+    auto frustum = camera.frustum();
+
+    auto uniform = [](float lo, float hi) { return lo + (hi - lo) * rand() / float(RAND_MAX); };
+
+    for(int i = 0; i < 1000; ++i)
+    {
+      auto centre = camera.position() + Vec3(uniform(-40, 40), uniform(-40, 40), uniform(-40, 40));
+      auto radius = uniform(0.1f, 10.0f);
+
+      bool visible = false;
+
+      for(int k = 0; k < 256; ++k)
+      {
+        auto pt = centre + radius * Vec3(uniform(-1, 1), uniform(-1, 1), uniform(-1, 1));
+
+        if (dist(pt, centre) <= radius)
+          visible |= contains(frustum, pt);
+      }
+
+      assert(!visible || intersects(frustum, Sphere(centre, radius)));
+    }
+
+    for(int i = 0; i < 1000; ++i)
+    {
+      auto position = camera.position() + Vec3(uniform(-40, 40), uniform(-40, 40), uniform(-40, 40));
+      auto direction = normalise(Vec3(uniform(-1, 1), uniform(-1, 1), uniform(-1, 1)) + Vec3(0.0f, 0.0f, 0.01f));
+      auto range = uniform(0.1f, 20.0f);
+      auto cutoff = uniform(-0.5f, 0.99f);
+
+      auto bound = spotlight_bound(position, direction, range, cutoff);
+
+      auto tangent = normalise(cross(direction, (abs(direction.x) < 0.9f) ? Vec3(1, 0, 0) : Vec3(0, 1, 0)));
+      auto bitangent = cross(direction, tangent);
+
+      bool visible = false;
+
+      for(int k = 0; k < 256; ++k)
+      {
+        auto theta = acos(cutoff) * uniform(0, 1);
+        auto phi = 2 * pi<float>() * uniform(0, 1);
+
+        auto pt = position + range * uniform(0, 1) * (cos(theta) * direction + sin(theta) * (cos(phi) * tangent + sin(phi) * bitangent));
+
+        assert(dist(pt, bound.centre) <= bound.radius * 1.001f + 0.001f);
+
+        visible |= contains(frustum, pt);
+      }
+
+      assert(!visible || intersects(frustum, bound));
+    }
+  }
+
+  const int TimedRunFrames = 1024;
+
+  ///////////////////////// timed_run ////////////////////////////////////////
+  [[maybe_unused]] void timed_run(GameState::TimedRun &run, const char *name, bool profiling, chrono::steady_clock::time_point start)
+  {
+    // the first frames of play alternate profiling off and on every 64
+    // frames, the mean frame cost of each is reported once at the end
+
+    if (run.frames < TimedRunFrames)
+    {
+      run.count[profiling] += 1;
+      run.elapsed[profiling] += chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+
+      run.frames += 1;
+
+      if (run.frames == TimedRunFrames)
+      {
+        cout << "Profiling Overhead (" << name << "): off " << run.elapsed[0] / max(run.count[0], 1) << "us, on " << run.elapsed[1] / max(run.count[1], 1) << "us" << endl;
+      }
+    }
+  }
+
+  struct FreeListBlock
+  {
+    void *ptr;
+    size_t bytes;
+    uint8_t tag;
+  };
+
+  struct FreeListRelease
+  {
+    ConcurrentFreeList *freelist;
+
+    FreeListBlock *blocks;
+    size_t count;
+
+    atomic<int> *errors;
+  };
+
+  ///////////////////////// release_blocks ///////////////////////////////////
+  void release_blocks(PlatformInterface &platform, void *ldata, void *rdata)
+  {
+    auto &work = *static_cast<FreeListRelease*>(rdata);
+
+    for(size_t i = 0; i < work.count; ++i)
+    {
+      auto &block = work.blocks[i];
+
+      for(size_t k = 0; k < block.bytes; ++k)
+      {
+        if (static_cast<uint8_t*>(block.ptr)[k] != block.tag)
+        {
+          *work.errors += 1;
+          break;
+        }
+      }
+
+      deallocate(work.freelist, block.ptr, block.bytes);
+    }
+  }
+
+  ///////////////////////// verify_concurrent_freelist ///////////////////////
+  [[maybe_unused]] void verify_concurrent_freelist(PlatformInterface &platform)
+  {
+    // stress : this thread acquires tagged blocks while the workers check and
+    // release the previous round, a block handed out twice breaks its tag
+
+    const int Rounds = 256;
+    const int Jobs = 8;
+    const int BlocksPerJob = 32;
+
+    auto arena = allocate(platform.gamescratchmemory, 4*1024*1024);
+
+    ConcurrentFreeList freelist;
+    StackAllocatorWithFreelist<uint8_t> allocator(arena, freelist);
+
+    atomic<int> errors(0);
+
+    WorkCounter counters[2];
+    FreeListRelease work[2][Jobs];
+    FreeListBlock blocks[2][Jobs * BlocksPerJob];
+
+    for(int round = 0; round < Rounds; ++round)
+    {
+      auto slot = round & 1;
+
+      platform.wait_work(&counters[slot]);
+
+      for(auto &block : blocks[slot])
+      {
+        block.bytes = 16 + rand() % 496;
+        block.ptr = allocator.allocate(block.bytes);
+        block.tag = uint8_t(round);
+
+        memset(block.ptr, block.tag, block.bytes);
+      }
+
+      for(int i = 0; i < Jobs; ++i)
+      {
+        work[slot][i].freelist = &freelist;
+        work[slot][i].blocks = blocks[slot] + i * BlocksPerJob;
+        work[slot][i].count = BlocksPerJob;
+        work[slot][i].errors = &errors;
+
+        platform.submit_work(release_blocks, nullptr, &work[slot][i], &counters[slot], nullptr);
+      }
+    }
+
+    platform.wait_work(&counters[0]);
+    platform.wait_work(&counters[1]);
+
+    assert(errors == 0);
+  }
+
+  struct GeometryBuild
+  {
+    Scene::EntityId const *entities;
+    size_t count;
+
+    GeometryList *geometry;
+  };
+
+  ///////////////////////// build_geometry ///////////////////////////////////
+  void build_geometry(PlatformInterface &platform, void *ldata, void *rdata)
+  {
+    auto &state = *static_cast<GameState*>(ldata);
+    auto &work = *static_cast<GeometryBuild*>(rdata);
+
+    ScratchScope scratch(state.threadarenas.local());
+
+    GeometryList::BuildState buildstate;
+
+    if (work.geometry->begin(buildstate, state.rendercontext, state.resources, scratch, state.camera))
+    {
+      for(size_t i = 0; i < work.count; ++i)
+      {
+        auto instance = state.scene.get_component<MeshComponent>(work.entities[i]);
+        auto transform = state.scene.get_component<TransformComponent>(work.entities[i]);
+
+        work.geometry->push_mesh(buildstate, transform.world(), instance.mesh(), instance.material());
+      }
+
+      work.geometry->finalise(buildstate);
+    }
+  }
+
 }
 
 
 ///////////////////////// GameState::Constructor ////////////////////////////
-GameState::GameState(StackAllocator<> const &allocator)
+GameState::GameState(StackAllocator<> const &allocator, size_t threads)
   : assets(allocator),
     resources(assets, allocator),
-    scene(allocator)
+    scene(allocator),
+    threadarenas(allocator, 2*1024*1024, threads),
+    renderarena(allocator, 12*1024*1024)
 {
   readframe = &renderframes[0];
   writeframe = &renderframes[1];
@@ -67,10 +274,20 @@ void datumtest_init(PlatformInterface &platform)
 {
   cout << "Init" << endl;
 
-  GameState &state = *new(allocate<GameState>(platform.gamememory)) GameState(platform.gamememory);
+  GameState &state = *new(allocate<GameState>(platform.gamememory)) GameState(platform.gamememory, platform.work_threads());
 
   assert(&state == platform.gamememory.data);
 
+  TRACK_ARENA(platform.gamememory, "Game")
+  TRACK_ARENA(platform.gamescratchmemory, "GameScratch")
+  TRACK_ARENA(platform.renderscratchmemory, "RenderScratch")
+
+  // the test app profiles (apart from the on/off timed run at the start of
+  // play), so each thread keeps a deeper log
+
+  set_debuglog_capacity(64*1024);
+  set_profiling(true);
+
   initialise_asset_system(platform, state.assets, 64*1024, 256*1024*1024);
 
   initialise_resource_system(platform, state.resources, 2*1024*1024, 8*1024*1024, 64*1024*1024, 1);
@@ -78,6 +295,9 @@ void datumtest_init(PlatformInterface &platform)
   initialise_render_context(platform, state.rendercontext, 16*1024*1024, 0);
   initialise_spotmap_context(platform, state.spotmapcontext, 0);
 
+  state.rendercontext.pipelinecache = load_pipelinecache(state.rendercontext.vulkan, "pipeline.cache");
+  state.spotmapcontext.pipelinecache = load_pipelinecache(state.spotmapcontext.vulkan, "pipeline.cache");
+
 //  config_render_pipeline(RenderPipelineConfig::EnableDepthOfField, true);
 //  config_render_pipeline(RenderPipelineConfig::EnableColorGrading, true);
 
@@ -228,6 +448,11 @@ void datumtest_init(PlatformInterface &platform)
   }
 #endif
 
+#ifndef NDEBUG
+  verify_light_culling(state.camera);
+  verify_concurrent_freelist(platform);
+#endif
+
   prefetch_core_assets(platform, state.assets);
 
   state.mode = GameState::Startup;
@@ -237,7 +462,12 @@ void datumtest_init(PlatformInterface &platform)
 ///////////////////////// game_update ///////////////////////////////////////
 void datumtest_update(PlatformInterface &platform, GameInput const &input, float dt)
 {
-  BEGIN_TIMED_BLOCK(Update, Color3(1.0f, 1.0f, 0.4f))
+#if defined(DEBUG) || defined(PROFILING)
+  auto start = chrono::steady_clock::now();
+  auto profiling = g_profiling.load(memory_order_relaxed);
+#endif
+
+  BEGIN_TIMED_BLOCK(Update, Color3(1.0f, 1.0f, 0.4f));
 
   GameState &state = *static_cast<GameState*>(platform.gamememory.data);
 
@@ -255,6 +485,10 @@ void datumtest_update(PlatformInterface &platform, GameInput const &input, float
     if (state.rendercontext.ready && state.spotmapcontext.ready && state.debugfont->ready())
     {
       state.mode = GameState::Load;
+
+      VkPipelineCache pipelinecaches[] = { state.rendercontext.pipelinecache, state.spotmapcontext.pipelinecache };
+
+      save_pipelinecache(state.rendercontext.vulkan, pipelinecaches, std::extent<decltype(pipelinecaches)>::value, "pipeline.cache");
     }
   }
 
@@ -350,6 +584,11 @@ void datumtest_update(PlatformInterface &platform, GameInput const &input, float
 
 #ifdef DEBUG
     state.luminancetarget = debug_menu_value("Camera/LumaTarget", state.luminancetarget, 0.0f, 8.0f);
+
+    auto profilingmenu = debug_menu_value("Debug/Profiling", true, false, true);
+
+    if (state.updaterun.frames == TimedRunFrames)
+      set_profiling(profilingmenu);
 #endif
 
     state.camera = adapt(state.camera, state.rendercontext.luminance, state.luminancetarget, 0.5f*dt);
@@ -387,12 +626,21 @@ void datumtest_update(PlatformInterface &platform, GameInput const &input, float
 
     state.resources.update(state.floormaterial, Color4(0.4f, 0.4f, 0.4f, 1.0f), floormetalness, floorroughness, floorflectivity);
 
+    state.posecache.reset();
+
+    DEBUG_MENU_VALUE("Lighting/Sun Intensity", &state.sunintensity, Color3(0, 0, 0), Color3(10, 10, 10))
+    DEBUG_MENU_ENTRY("Lighting/Sun Direction", state.sundirection = normalise(debug_menu_value("Lighting/Sun Direction", state.sundirection, Vec3(-1), Vec3(1))))
+
 #if 1
     {
       CasterList::BuildState buildstate;
 
-      if (state.writeframe->casters.begin(buildstate, state.rendercontext, state.resources))
+      // casters are culled against the cascades render() derives from this camera and sun
+
+      if (state.writeframe->casters.begin(buildstate, state.rendercontext, state.resources, platform.gamescratchmemory, state.camera, state.sundirection))
       {
+        buildstate.posecache = &state.posecache;
+
         for(auto &entity : state.scene.entities<MeshComponent>())
         {
           auto instance = state.scene.get_component<MeshComponent>(entity);
@@ -416,33 +664,57 @@ void datumtest_update(PlatformInterface &platform, GameInput const &input, float
 
 #if 1
     {
-      GeometryList::BuildState buildstate;
+      // scene meshes are split over sublists built on the worker threads,
+      // the test meshes and actors go in the first sublist, built here
+
+      vector<Scene::EntityId, StackAllocator<Scene::EntityId>> meshes(platform.gamescratchmemory);
 
-      if (state.writeframe->geometry.begin(buildstate, state.rendercontext, state.resources))
+      for(auto &entity : state.scene.entities<MeshComponent>())
       {
-        state.writeframe->geometry.push_mesh(buildstate, Transform::translation(-3, 1, -3)*Transform::rotation(Vec3(0, 1, 0), state.time), state.suzanne, state.suzannematerial);
+        meshes.push_back(entity);
+      }
 
-        state.writeframe->geometry.push_mesh(buildstate, Transform::identity(), state.testplane, state.floormaterial);
-//        state.writeframe->geometry.push_ocean(buildstate, Transform::translation(0, 0, 0), state.testplane, state.oceanmaterial, Vec2(0.001f*state.time), Vec3(20.0f, 20.0f, 0.4f), Plane({ 0, 1, 0 }, -0));
+      WorkCounter counter;
 
-        for(auto &entity : state.scene.entities<MeshComponent>())
-        {
-          auto instance = state.scene.get_component<MeshComponent>(entity);
-          auto transform = state.scene.get_component<TransformComponent>(entity);
+      GeometryBuild work[GameState::GeometrySubLists];
 
-          state.writeframe->geometry.push_mesh(buildstate, transform.world(), instance.mesh(), instance.material());
-        }
+      for(int i = 1; i < GameState::GeometrySubLists; ++i)
+      {
+        auto first = (i - 1) * meshes.size() / (GameState::GeometrySubLists - 1);
+        auto last = i * meshes.size() / (GameState::GeometrySubLists - 1);
+
+        work[i].entities = meshes.data() + first;
+        work[i].count = last - first;
+        work[i].geometry = &state.writeframe->geometry[i];
+
+        platform.submit_work(build_geometry, &state, &work[i], &counter, nullptr);
+      }
+
+      GeometryList::BuildState buildstate;
+
+      auto &geometry = state.writeframe->geometry[0];
+
+      if (geometry.begin(buildstate, state.rendercontext, state.resources, platform.gamescratchmemory, state.camera))
+      {
+        buildstate.posecache = &state.posecache;
+
+        geometry.push_mesh(buildstate, Transform::translation(-3, 1, -3)*Transform::rotation(Vec3(0, 1, 0), state.time), state.suzanne, state.suzannematerial);
+
+        geometry.push_mesh(buildstate, Transform::identity(), state.testplane, state.floormaterial);
+//        geometry.push_ocean(buildstate, Transform::translation(0, 0, 0), state.testplane, state.oceanmaterial, Vec2(0.001f*state.time), Vec3(20.0f, 20.0f, 0.4f), Plane({ 0, 1, 0 }, -0));
 
         for(auto &entity : state.scene.entities<ActorComponent>())
         {
           auto instance = state.scene.get_component<ActorComponent>(entity);
           auto transform = state.scene.get_component<TransformComponent>(entity);
 
-          state.writeframe->geometry.push_mesh(buildstate, transform.world(), instance.pose(), instance.mesh(), instance.material());
+          geometry.push_mesh(buildstate, transform.world(), instance.pose(), instance.mesh(), instance.material());
         }
 
-        state.writeframe->geometry.finalise(buildstate);
+        geometry.finalise(buildstate);
       }
+
+      platform.wait_work(&counter);
     }
 #endif
 
@@ -458,7 +730,7 @@ void datumtest_update(PlatformInterface &platform, GameInput const &input, float
 
       LightList::BuildState buildstate;
 
-      if (state.writeframe->lights.begin(buildstate, state.rendercontext, state.resources))
+      if (state.writeframe->lights.begin(buildstate, state.rendercontext, state.resources, state.camera))
       {
         for(auto &entity : state.scene.entities<PointLightComponent>())
         {
@@ -498,9 +770,6 @@ void datumtest_update(PlatformInterface &platform, GameInput const &input, float
     }
 #endif
 
-    DEBUG_MENU_VALUE("Lighting/Sun Intensity", &state.sunintensity, Color3(0, 0, 0), Color3(10, 10, 10))
-    DEBUG_MENU_ENTRY("Lighting/Sun Direction", state.sundirection = normalise(debug_menu_value("Lighting/Sun Direction", state.sundirection, Vec3(-1), Vec3(1))))
-
     state.writeframe->skybox = state.skybox;
     state.writeframe->sundirection = state.sundirection;
     state.writeframe->sunintensity = state.sunintensity;
@@ -520,7 +789,16 @@ void datumtest_update(PlatformInterface &platform, GameInput const &input, float
 
   state.writeframe = state.readyframe.exchange(state.writeframe);
 
-  END_TIMED_BLOCK(Update)
+  END_TIMED_BLOCK(Update);
+
+#if defined(DEBUG) || defined(PROFILING)
+  if (state.mode == GameState::Play && state.updaterun.frames < TimedRunFrames)
+  {
+    timed_run(state.updaterun, "update", profiling, start);
+
+    set_profiling((state.updaterun.frames / 64) % 2 == 1 || state.updaterun.frames == TimedRunFrames);
+  }
+#endif
 
   stream_debuglog("debuglog.dump");
 }
@@ -529,7 +807,7 @@ void datumtest_update(PlatformInterface &platform, GameInput const &input, float
 ///////////////////////// game_render ///////////////////////////////////////
 void datumtest_render(PlatformInterface &platform, Viewport const &viewport)
 {
-  BEGIN_FRAME()
+  BEGIN_FRAME();
 
   GameState &state = *static_cast<GameState*>(platform.gamememory.data);
 
@@ -538,7 +816,12 @@ void datumtest_render(PlatformInterface &platform, Viewport const &viewport)
 
   state.readframe = state.readyframe.exchange(state.readframe);
 
-  BEGIN_TIMED_BLOCK(Render, Color3(0.0f, 0.2f, 1.0f))
+#if defined(DEBUG) || defined(PROFILING)
+  auto start = chrono::steady_clock::now();
+  auto profiling = g_profiling.load(memory_order_relaxed);
+#endif
+
+  BEGIN_TIMED_BLOCK(Render, Color3(0.0f, 0.2f, 1.0f));
 
   if (state.readframe->mode == GameState::Startup)
   {
@@ -569,10 +852,15 @@ void datumtest_render(PlatformInterface &platform, Viewport const &viewport)
   {
     auto &camera = state.readframe->camera;
 
-    RenderList renderlist(platform.renderscratchmemory, 8*1024*1024);
+    // per-frame render data lives in the frame arena, the previous frame's
+    // list stays intact until the next flip
+
+    state.renderarena.flip();
+
+    RenderList renderlist(state.renderarena.current(), 8*1024*1024);
 
     renderlist.push_casters(state.readframe->casters);
-    renderlist.push_geometry(state.readframe->geometry);
+    renderlist.push_geometry(state.readframe->geometry, GameState::GeometrySubLists);
     renderlist.push_lights(state.readframe->lights);
     renderlist.push_sprites(state.readframe->sprites);
 
@@ -688,12 +976,12 @@ void datumtest_render(PlatformInterface &platform, Viewport const &viewport)
 
 #if 1
     {
-      BEGIN_TIMED_BLOCK(SpotMap, Color3(0.1f, 0.4f, 0.1f))
+      BEGIN_TIMED_BLOCK(SpotMap, Color3(0.1f, 0.4f, 0.1f));
 
       SpotCasterList casters;
       SpotCasterList::BuildState buildstate;
 
-      if (casters.begin(buildstate, state.spotmapcontext, state.resources))
+      if (casters.begin(buildstate, state.spotmapcontext, state.resources, state.testspotview, 0.25f, 12))
       {
         buildstate.width = state.testspotcaster->width;
         buildstate.height = state.testspotcaster->height;
@@ -728,7 +1016,7 @@ void datumtest_render(PlatformInterface &platform, Viewport const &viewport)
 
       render_spotmaps(state.spotmapcontext, spotmaps, 1, spotparams);
 
-      END_TIMED_BLOCK(SpotMap)
+      END_TIMED_BLOCK(SpotMap);
     }
 #endif
 
@@ -758,5 +1046,10 @@ void datumtest_render(PlatformInterface &platform, Viewport const &viewport)
 
   state.resources.release(state.readframe->resourcetoken);
 
-  END_TIMED_BLOCK(Render)
+  END_TIMED_BLOCK(Render);
+
+#if defined(DEBUG) || defined(PROFILING)
+  if (state.readframe->mode == GameState::Play)
+    timed_run(state.renderrun, "render", profiling, start);
+#endif
 }
@@ -20,7 +20,7 @@ struct GameState
   using Transform = lml::Transform;
   using Attenuation = lml::Attenuation;
 
-  GameState(StackAllocator<> const &allocator);
+  GameState(StackAllocator<> const &allocator, std::size_t threads);
 
   const float fov = 60.0f;
   const float aspect = 1920.0f/1080.0f;
@@ -52,8 +52,14 @@ struct GameState
   RenderContext rendercontext;
   SpotMapContext spotmapcontext;
 
+  PoseCache posecache { &rendercontext };
+
   Scene scene;
 
+  ThreadArenas threadarenas;
+
+  FrameArena renderarena;
+
   Mesh const *testplane;
   Mesh const *testsphere;
   Mesh const *testcube;
@@ -78,8 +84,22 @@ struct GameState
   Vec3 sundirection = normalise(Vec3(0.4f, -1.0f, -0.1f));
   Color3 sunintensity = Color3(8.0f, 8.0f, 8.0f);
 
+  // Profiling Overhead
+
+  struct TimedRun
+  {
+    int frames = 0;
+    int count[2] = {};
+    double elapsed[2] = {};
+  };
+
+  TimedRun updaterun;
+  TimedRun renderrun;
+
   // Render Frames
 
+  static constexpr int GeometrySubLists = 4;
+
   struct RenderFrame
   {
     int mode;
@@ -93,7 +113,7 @@ struct GameState
     Color3 sunintensity;
 
     CasterList casters;
-    GeometryList geometry;
+    GeometryList geometry[GeometrySubLists];
     LightList lights;
     SpriteList sprites;
 
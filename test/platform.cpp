@@ -7,10 +7,22 @@
 //
 
 #include "platform.h"
+#include "datum/memory.h"
 #include <memory>
+#include <algorithm>
 #include <cstddef>
 #include <iostream>
 
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
 using namespace std;
 
 namespace
@@ -298,33 +310,146 @@ namespace DatumPlatform
   //|---------------------- WorkQueue -----------------------------------------
   //|--------------------------------------------------------------------------
 
+  ///////////////////////// WorkQueue::Deque::push ////////////////////////////
+  bool WorkQueue::Deque::push(Job *job)
+  {
+    auto b = bottom.load(std::memory_order_relaxed);
+    auto t = top.load(std::memory_order_acquire);
+
+    if (b - t >= DequeSize)
+      return false;
+
+    jobs[b & (DequeSize - 1)].store(job, std::memory_order_relaxed);
+
+    bottom.store(b + 1, std::memory_order_release);
+
+    return true;
+  }
+
+
+  ///////////////////////// WorkQueue::Deque::pop /////////////////////////////
+  WorkQueue::Job *WorkQueue::Deque::pop()
+  {
+    auto b = bottom.load(std::memory_order_relaxed) - 1;
+
+    bottom.store(b, std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    auto t = top.load(std::memory_order_relaxed);
+
+    if (t > b)
+    {
+      bottom.store(b + 1, std::memory_order_relaxed);
+
+      return nullptr;
+    }
+
+    auto job = jobs[b & (DequeSize - 1)].load(std::memory_order_relaxed);
+
+    if (t == b)
+    {
+      // last job, race any thieves for it
+
+      if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        job = nullptr;
+
+      bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    return job;
+  }
+
+
+  ///////////////////////// WorkQueue::Deque::steal ///////////////////////////
+  WorkQueue::Job *WorkQueue::Deque::steal()
+  {
+    auto t = top.load(std::memory_order_acquire);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    auto b = bottom.load(std::memory_order_acquire);
+
+    if (t >= b)
+      return nullptr;
+
+    auto job = jobs[t & (DequeSize - 1)].load(std::memory_order_relaxed);
+
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      return nullptr;
+
+    return job;
+  }
+
+
   ///////////////////////// WorkQueue::Constructor ////////////////////////////
   WorkQueue::WorkQueue(int threads)
   {
+    if (threads <= 0)
+      threads = max(int(thread::hardware_concurrency()) - 1, 1);
+
+    threads = min(threads, MaxThreads / 2);
+
     m_done = false;
+    m_sleeping = 0;
+    m_threadcount = 0;
+
+    m_spillhead = nullptr;
+    m_spilltail = nullptr;
+    m_spillcount = 0;
+
+    m_deques.reset(new Deque[MaxThreads]);
+
+    for(int i = 0; i < MaxThreads; ++i)
+    {
+      m_deques[i].top = 0;
+      m_deques[i].bottom = 0;
+    }
+
+    m_jobs.reset(new Job[PoolSize]);
+
+    for(int i = 0; i < PoolSize; ++i)
+    {
+      m_jobs[i].next = (i + 1 < PoolSize) ? i + 2 : 0;
+    }
+
+    m_freejobs = 1;
 
     for(int i = 0; i < threads; ++i)
     {
       m_threads.emplace_back([=]() {
 
-        while (!m_done)
-        {
-          std::function<void()> work;
+        int index = local();
 
+        while (true)
+        {
+          if (Job *job = acquire(index))
           {
-            unique_lock<std::mutex> lock(m_mutex);
+            execute(job);
 
-            while (m_queue.empty())
-            {
-              m_signal.wait(lock);
-            }
+            continue;
+          }
 
-            work = std::move(m_queue.front());
+          unique_lock<std::mutex> lock(m_mutex);
 
-            m_queue.pop_front();
-          }
+          if (m_done)
+            break;
 
-          work();
+          m_sleeping.fetch_add(1);
+
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+
+          bool empty = true;
+
+          for(int k = 0, count = min(m_threadcount.load(), int(MaxThreads)); k < count; ++k)
+            empty &= (m_deques[k].top.load() >= m_deques[k].bottom.load());
+
+          empty &= (m_spillcount.load() == 0);
+
+          if (empty)
+            m_signal.wait(lock);
+
+          m_sleeping.fetch_sub(1);
         }
 
       });
@@ -335,40 +460,498 @@ namespace DatumPlatform
   ///////////////////////// WorkQueue::Destructor /////////////////////////////
   WorkQueue::~WorkQueue()
   {
-    for(size_t i = 0; i < m_threads.size(); ++i)
-      push([=]() { m_done = true; });
+    {
+      lock_guard<std::mutex> lock(m_mutex);
+
+      m_done = true;
+    }
+
+    m_signal.notify_all();
 
     for(auto &thread : m_threads)
       thread.join();
   }
 
 
+  ///////////////////////// WorkQueue::local //////////////////////////////////
+  int WorkQueue::local()
+  {
+    auto index = int(thread_index());
+
+    // threads beyond the deque table have no deque, they submit through the
+    // spill list and only steal
+
+    if (index >= MaxThreads)
+      return -1;
+
+    // threads are numbered process wide, so track the highest deque in use
+
+    auto count = m_threadcount.load(std::memory_order_relaxed);
+
+    while (count <= index && !m_threadcount.compare_exchange_weak(count, index + 1, std::memory_order_relaxed))
+      ;
+
+    return index;
+  }
+
+
+  ///////////////////////// WorkQueue::allocate ///////////////////////////////
+  WorkQueue::Job *WorkQueue::allocate()
+  {
+    while (true)
+    {
+      auto head = m_freejobs.load(std::memory_order_acquire);
+
+      while (uint32_t(head) != 0)
+      {
+        auto job = &m_jobs[uint32_t(head) - 1];
+
+        auto next = job->next.load(std::memory_order_relaxed);
+
+        if (m_freejobs.compare_exchange_weak(head, ((head >> 32) + 1) << 32 | next, std::memory_order_acquire, std::memory_order_acquire))
+          return job;
+      }
+
+      // pool exhausted, help run queued work until a job is released rather
+      // than fall back to the heap (a submitter holding a lock that queued
+      // jobs need must stay within the pool)
+
+      if (Job *job = acquire(local()))
+        execute(job);
+      else
+        this_thread::yield();
+    }
+  }
+
+
+  ///////////////////////// WorkQueue::release ////////////////////////////////
+  void WorkQueue::release(Job *job)
+  {
+    auto index = uint32_t(job - m_jobs.get()) + 1;
+
+    auto head = m_freejobs.load(std::memory_order_relaxed);
+
+    do
+    {
+      job->next.store(uint32_t(head), std::memory_order_relaxed);
+
+    } while (!m_freejobs.compare_exchange_weak(head, ((head >> 32) + 1) << 32 | index, std::memory_order_release, std::memory_order_relaxed));
+  }
+
+
+  ///////////////////////// WorkQueue::push ///////////////////////////////////
+  void WorkQueue::push(work_t func, PlatformInterface *platform, void *ldata, void *rdata, WorkCounter *counter, WorkCounter *dependency)
+  {
+    auto job = allocate();
+
+    job->func = func;
+    job->platform = platform;
+    job->ldata = ldata;
+    job->rdata = rdata;
+    job->counter = counter;
+    job->waitnext = nullptr;
+
+    if (counter)
+      counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+    if (dependency)
+    {
+      lock_guard<std::mutex> lock(m_waitlock);
+
+      if (dependency->pending.load(std::memory_order_relaxed) != 0)
+      {
+        job->waitnext = static_cast<Job*>(dependency->waiters);
+
+        dependency->waiters = job;
+
+        return;
+      }
+    }
+
+    enqueue(job);
+  }
+
+
+  ///////////////////////// WorkQueue::enqueue ////////////////////////////////
+  void WorkQueue::enqueue(Job *job)
+  {
+    auto index = local();
+
+    if (index < 0 || !m_deques[index].push(job))
+    {
+      // no deque or deque full, spill rather than run inline, the caller may
+      // hold locks that the job needs
+
+      lock_guard<std::mutex> lock(m_spilllock);
+
+      job->waitnext = nullptr;
+
+      if (m_spilltail)
+        m_spilltail->waitnext = job;
+      else
+        m_spillhead = job;
+
+      m_spilltail = job;
+
+      m_spillcount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (m_sleeping.load(std::memory_order_relaxed) != 0)
+    {
+      lock_guard<std::mutex> lock(m_mutex);
+
+      m_signal.notify_one();
+    }
+  }
+
+
+  ///////////////////////// WorkQueue::acquire ////////////////////////////////
+  WorkQueue::Job *WorkQueue::acquire(int index)
+  {
+    if (index >= 0)
+    {
+      if (Job *job = m_deques[index].pop())
+        return job;
+    }
+
+    int count = min(m_threadcount.load(std::memory_order_relaxed), int(MaxThreads));
+
+    for(int i = (index < 0) ? 0 : 1; i < count; ++i)
+    {
+      if (Job *job = m_deques[(max(index, 0) + i) % count].steal())
+        return job;
+    }
+
+    if (m_spillcount.load(std::memory_order_relaxed) != 0)
+    {
+      lock_guard<std::mutex> lock(m_spilllock);
+
+      if (Job *job = m_spillhead)
+      {
+        m_spillhead = job->waitnext;
+
+        if (!m_spillhead)
+          m_spilltail = nullptr;
+
+        m_spillcount.fetch_sub(1, std::memory_order_relaxed);
+
+        return job;
+      }
+    }
+
+    return nullptr;
+  }
+
+
+  ///////////////////////// WorkQueue::execute ////////////////////////////////
+  void WorkQueue::execute(Job *job)
+  {
+    job->func(*job->platform, job->ldata, job->rdata);
+
+    auto counter = job->counter;
+
+    release(job);
+
+    complete(counter);
+  }
+
+
+  ///////////////////////// WorkQueue::complete ///////////////////////////////
+  void WorkQueue::complete(WorkCounter *counter)
+  {
+    if (!counter)
+      return;
+
+    auto pending = counter->pending.load(std::memory_order_relaxed);
+
+    while (pending > 1)
+    {
+      if (counter->pending.compare_exchange_weak(pending, pending - 1, std::memory_order_release, std::memory_order_relaxed))
+        return;
+    }
+
+    // the final decrement is made under the wait lock so dependent jobs are
+    // never missed, and a waiter knows the counter is no longer referenced
+
+    Job *waiters = nullptr;
+
+    {
+      lock_guard<std::mutex> lock(m_waitlock);
+
+      if (counter->pending.fetch_sub(1, std::memory_order_release) == 1)
+      {
+        waiters = static_cast<Job*>(counter->waiters);
+
+        counter->waiters = nullptr;
+      }
+    }
+
+    while (waiters)
+    {
+      auto job = waiters;
+
+      waiters = job->waitnext;
+
+      enqueue(job);
+    }
+  }
+
+
+  ///////////////////////// WorkQueue::wait ///////////////////////////////////
+  void WorkQueue::wait(WorkCounter *counter)
+  {
+    int index = local();
+
+    while (counter->pending.load(std::memory_order_acquire) != 0)
+    {
+      if (Job *job = acquire(index))
+        execute(job);
+      else
+        this_thread::yield();
+    }
+
+    lock_guard<std::mutex> lock(m_waitlock);
+  }
+
+
   //|---------------------- File Handle ---------------------------------------
   //|--------------------------------------------------------------------------
 
   ///////////////////////// FileHandle::Constructor ///////////////////////////
   FileHandle::FileHandle(const char *path)
   {
-    m_fio.open(path, ios::in | ios::binary);
+#ifdef _WIN32
+    m_handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
 
-    if (!m_fio)
+    if (m_handle == INVALID_HANDLE_VALUE)
       throw runtime_error(string("FileHandle Open Error: ") + path);
+#else
+    m_fd = ::open(path, O_RDONLY | O_CLOEXEC);
+
+    if (m_fd < 0)
+      throw runtime_error(string("FileHandle Open Error: ") + path);
+#endif
+  }
+
+
+  ///////////////////////// FileHandle::Destructor ////////////////////////////
+  FileHandle::~FileHandle()
+  {
+#ifdef _WIN32
+    CloseHandle(m_handle);
+#else
+    ::close(m_fd);
+#endif
   }
 
 
   ///////////////////////// FileHandle::Read //////////////////////////////////
   size_t FileHandle::read(uint64_t position, void *buffer, size_t bytes)
-  {  
-    lock_guard<mutex> lock(m_lock);
+  {
+    // positional reads, no shared file offset so no lock
+
+    size_t total = 0;
+
+    while (total < bytes)
+    {
+#ifdef _WIN32
+      OVERLAPPED overlapped = {};
+      overlapped.Offset = (DWORD)(position + total);
+      overlapped.OffsetHigh = (DWORD)((position + total) >> 32);
+
+      DWORD count = 0;
+
+      if (!ReadFile(m_handle, (char*)buffer + total, (DWORD)min(bytes - total, size_t(0x40000000)), &count, &overlapped))
+      {
+        if (GetLastError() == ERROR_HANDLE_EOF)
+          break;
+
+        throw runtime_error("FileHandle Read Error");
+      }
+#else
+      auto count = ::pread(m_fd, (char*)buffer + total, bytes - total, position + total);
+
+      if (count < 0)
+      {
+        if (errno == EINTR)
+          continue;
+
+        throw runtime_error("FileHandle Read Error");
+      }
+#endif
+
+      if (count == 0)
+        break;
+
+      total += count;
+    }
 
-    m_fio.seekg(position);
+    return total;
+  }
+
+
+
+  //|---------------------- IOQueue -------------------------------------------
+  //|--------------------------------------------------------------------------
 
-    m_fio.read((char*)buffer, bytes);
+  ///////////////////////// IOQueue::Constructor //////////////////////////////
+  IOQueue::IOQueue(int threads)
+  {
+    m_done = false;
+
+    m_reads.reset(new AsyncRead[PoolSize]);
 
-    if (m_fio.bad())
-      throw runtime_error("FileHandle Read Error");
+    for(int i = 0; i < PoolSize; ++i)
+    {
+      m_reads[i].overflow = false;
+      m_reads[i].next = (i + 1 < PoolSize) ? &m_reads[i + 1] : nullptr;
+    }
+
+    m_freereads = &m_reads[0];
+
+    for(int i = 0; i < threads; ++i)
+    {
+      m_threads.emplace_back([=]() {
+
+        while (true)
+        {
+          Read read;
+
+          {
+            unique_lock<std::mutex> lock(m_mutex);
+
+            while (!m_done && m_queue.empty())
+            {
+              m_signal.wait(lock);
+            }
+
+            if (m_queue.empty())
+              break;
+
+            read = m_queue.front();
+
+            m_queue.pop_front();
+          }
+
+          execute(read);
+        }
+
+      });
+    }
+  }
+
+
+  ///////////////////////// IOQueue::Destructor ///////////////////////////////
+  IOQueue::~IOQueue()
+  {
+    {
+      lock_guard<std::mutex> lock(m_mutex);
+
+      m_done = true;
+    }
+
+    m_signal.notify_all();
+
+    for(auto &thread : m_threads)
+      thread.join();
+  }
+
+
+  ///////////////////////// IOQueue::execute //////////////////////////////////
+  void IOQueue::execute(Read const &read)
+  {
+    try
+    {
+      read.request->result = read.request->file->read(read.request->position, read.request->buffer, read.request->bytes);
+    }
+    catch(...)
+    {
+      read.request->result = 0;
+    }
+
+    if (read.async)
+    {
+      read.async->workqueue->push(complete, read.async->platform, this, read.async);
+    }
+  }
+
+
+  ///////////////////////// IOQueue::complete /////////////////////////////////
+  void IOQueue::complete(PlatformInterface &platform, void *ldata, void *rdata)
+  {
+    auto &queue = *static_cast<IOQueue*>(ldata);
+
+    auto read = static_cast<AsyncRead*>(rdata);
+
+    auto callback = read->callback;
+    auto userdata = read->userdata;
+    auto bytes = read->request.result;
+
+    if (read->overflow)
+    {
+      delete read;
+    }
+    else
+    {
+      lock_guard<std::mutex> lock(queue.m_mutex);
+
+      read->next = queue.m_freereads;
+
+      queue.m_freereads = read;
+    }
+
+    callback(platform, userdata, bytes);
+  }
+
+
+  ///////////////////////// IOQueue::read_async ///////////////////////////////
+  void IOQueue::read_async(WorkQueue &workqueue, PlatformInterface *platform, FileHandle *file, uint64_t position, void *buffer, size_t bytes, callback_t callback, void *userdata)
+  {
+    AsyncRead *read = nullptr;
+
+    {
+      lock_guard<std::mutex> lock(m_mutex);
+
+      if (m_freereads)
+      {
+        read = m_freereads;
+
+        m_freereads = read->next;
+      }
+    }
+
+    if (!read)
+    {
+      // read pool exhausted, overflow from the heap so the callback still
+      // completes on the work queue and never on the caller's stack
+
+      read = new AsyncRead;
+
+      read->overflow = true;
+    }
+
+    read->request = { file, position, buffer, bytes, 0 };
+    read->workqueue = &workqueue;
+    read->platform = platform;
+    read->callback = callback;
+    read->userdata = userdata;
+
+    if (m_threads.size() == 0)
+    {
+      execute({ &read->request, read });
+
+      return;
+    }
+
+    {
+      lock_guard<std::mutex> lock(m_mutex);
+
+      m_queue.push_back({ &read->request, read });
+    }
 
-    return m_fio.gcount();
+    m_signal.notify_one();
   }
 
 } // namespace
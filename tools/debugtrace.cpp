@@ -0,0 +1,46 @@
+//
+// Datum - debug trace
+//
+
+//
+// Copyright (c) 2017 Peter Niekamp
+//
+
+#include <iostream>
+#include <fstream>
+#include "tracewriter.h"
+
+using namespace std;
+
+///////////////////////// main //////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  cout << "Debug trace" << endl;
+
+  if (argc < 3)
+  {
+    cout << "Usage: debugtrace <debuglog.dump> <trace.json>" << endl;
+    exit(1);
+  }
+
+  try
+  {
+    ifstream fin(argv[1], ios::binary);
+
+    if (!fin)
+      throw runtime_error(string("Unable to read: ") + argv[1]);
+
+    ofstream fout(argv[2], ios::trunc);
+
+    if (!fout)
+      throw runtime_error(string("Unable to write: ") + argv[2]);
+
+    write_chrome_trace(fin, fout);
+
+    cout << "Written: " << argv[2] << endl;
+  }
+  catch(exception &e)
+  {
+    cerr << "Critical Error: " << e.what() << endl;
+  }
+}
@@ -21,6 +21,7 @@
 #include <fstream>
 #include <thread>
 #include <unordered_map>
+#include <algorithm>
 #include <cassert>
 
 #include <QDebug>
@@ -61,13 +62,13 @@ struct DebugLogEntry
     HitCount
   };
 
-  EntryType type;
-  std::thread::id thread;
-  unsigned long long timestamp;
+  unsigned long long timestamp : 52;
+  unsigned long long type : 6;
+  unsigned long long thread : 6;
 
   union
   {
-    size_t hitcount;
+    uint64_t hitcount;
 
     struct
     {
@@ -75,7 +76,11 @@ struct DebugLogEntry
       uint32_t resourcecapacity;
     };
 
-    DebugInfoBlock const *info;
+    struct
+    {
+      uint32_t info;
+      uint32_t duration;
+    };
   };
 };
 
@@ -88,6 +93,7 @@ struct DebugLogEntry
 struct DebugLogHeader
 {
   uint32_t magic;
+  uint32_t version;
   double clockfrequency;
 };
 
@@ -99,7 +105,7 @@ struct DebugLogChunk
 
 struct DebugLogInfoChunk // type = 1
 {
-  DebugInfoBlock const *id;
+  uint32_t id;
 
   char name[256];
   char filename[512];
@@ -133,7 +139,7 @@ class DebugView : public QAbstractScrollArea
 
   public slots:
 
-    void load(unordered_map<DebugInfoBlock const *, DebugLogInfoChunk> const &infos, vector<DebugLogEntry> const &log, double clockfrequency);
+    void load(unordered_map<uint32_t, DebugLogInfoChunk> const &infos, vector<DebugLogEntry> const &log, double clockfrequency);
 
   protected:
 
@@ -177,7 +183,7 @@ DebugView::DebugView(QWidget *parent)
 
 
 ///////////////////////// DebugView::load ///////////////////////////////////
-void DebugView::load(unordered_map<DebugInfoBlock const *, DebugLogInfoChunk> const &infos, vector<DebugLogEntry> const &log, double clockfrequency)
+void DebugView::load(unordered_map<uint32_t, DebugLogInfoChunk> const &infos, vector<DebugLogEntry> const &log, double clockfrequency)
 {
   m_mintime = numeric_limits<double>::max();
   m_maxtime = numeric_limits<double>::lowest();
@@ -355,8 +361,11 @@ void DebugViewer::load(string const &filename)
   if (header.magic != 0x44544d44)
     throw runtime_error("Invalid File Header");
 
+  if (header.version != 2)
+    throw runtime_error("Unsupported File Version");
+
   vector<DebugLogEntry> log;
-  unordered_map<DebugInfoBlock const *,DebugLogInfoChunk> infos;
+  unordered_map<uint32_t, DebugLogInfoChunk> infos;
 
   while (fin)
   {
@@ -394,6 +403,10 @@ void DebugViewer::load(string const &filename)
     }
   }
 
+  // entries are streamed per thread
+
+  stable_sort(log.begin(), log.end(), [](auto &lhs, auto &rhs) { return lhs.timestamp < rhs.timestamp; });
+
   m_debugview->load(infos, log, header.clockfrequency);
 }
 
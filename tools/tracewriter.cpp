@@ -0,0 +1,364 @@
+//
+// Datum - trace writer
+//
+
+//
+// Copyright (c) 2017 Peter Niekamp
+//
+
+#include "tracewriter.h"
+#include "datum/math.h"
+#include <unordered_map>
+#include <string>
+#include <cstdio>
+#include <cstdarg>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+using namespace lml;
+
+//
+// Timing
+//
+
+struct DebugLogEntry
+{
+  enum EntryType
+  {
+    Empty,
+    FrameMarker,
+    EnterBlock,
+    ExitBlock,
+    GpuSubmit,
+    GpuBlock,
+
+    RenderLump,
+    RenderStorage,
+    ResourceSlot,
+    ResourceBuffer,
+    EntitySlot,
+
+    HitCount
+  };
+
+  unsigned long long timestamp : 52;
+  unsigned long long type : 6;
+  unsigned long long thread : 6;
+
+  union
+  {
+    uint64_t hitcount;
+
+    struct
+    {
+      uint32_t resourceused;
+      uint32_t resourcecapacity;
+    };
+
+    struct
+    {
+      uint32_t info;
+      uint32_t duration;
+    };
+  };
+};
+
+//
+// Log Dump
+//
+
+#pragma pack(push, 1)
+
+struct DebugLogHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  double clockfrequency;
+};
+
+struct DebugLogChunk
+{
+  uint32_t length;
+  uint32_t type;
+};
+
+struct DebugLogInfoChunk // type = 1
+{
+  uint32_t id;
+
+  char name[256];
+  char filename[512];
+  int linenumber;
+  Color3 color;
+};
+
+struct DebugLogArenaChunk // type = 3
+{
+  unsigned long long timestamp;
+
+  char tag[32];
+
+  uint64_t capacity;
+  uint64_t size;
+  uint64_t highwater;
+  uint64_t allocations;
+  uint64_t allocatedbytes;
+  uint64_t freelisthits;
+  uint64_t freelistmisses;
+  uint64_t freebytes;
+};
+
+#pragma pack(pop)
+
+namespace
+{
+  const int GpuTrack = 1000;
+
+  const char *resource_name(int type)
+  {
+    switch(type)
+    {
+      case DebugLogEntry::RenderLump:
+        return "Render Lumps";
+
+      case DebugLogEntry::RenderStorage:
+        return "Render Storage";
+
+      case DebugLogEntry::ResourceSlot:
+        return "Resource Slots";
+
+      case DebugLogEntry::ResourceBuffer:
+        return "Resource Buffers";
+
+      case DebugLogEntry::EntitySlot:
+        return "Entity Slots";
+    }
+
+    return "Unknown";
+  }
+
+  string escape(const char *str)
+  {
+    string result;
+
+    for(const char *ch = str; *ch; ++ch)
+    {
+      if (*ch == '"' || *ch == '\\')
+        result += '\\';
+
+      if (*ch >= 0x20)
+        result += *ch;
+    }
+
+    return result;
+  }
+
+  class TraceWriter
+  {
+    public:
+
+      TraceWriter(ostream &fout, double clockfrequency);
+      ~TraceWriter();
+
+      void info(DebugLogInfoChunk const &info);
+
+      void entry(DebugLogEntry const &entry);
+
+      void arena(DebugLogArenaChunk const &arena);
+
+    private:
+
+      double micros(unsigned long long ticks) const { return ticks * 1000000.0 / m_clockfrequency; }
+
+      void thread(int tid, const char *name);
+
+      void event(const char *fmt, ...);
+
+      ostream &m_fout;
+
+      double m_clockfrequency;
+
+      bool m_first = true;
+
+      unsigned long long m_seen = 0;
+
+      unsigned long long m_gpubase[64] = {};
+
+      unordered_map<uint32_t, string> m_names;
+  };
+
+
+  ///////////////////////// TraceWriter::Constructor ////////////////////////
+  TraceWriter::TraceWriter(ostream &fout, double clockfrequency)
+    : m_fout(fout),
+      m_clockfrequency(clockfrequency)
+  {
+    m_fout << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    event("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"GPU\"}}", GpuTrack);
+  }
+
+
+  ///////////////////////// TraceWriter::Destructor /////////////////////////
+  TraceWriter::~TraceWriter()
+  {
+    m_fout << "\n]}\n";
+  }
+
+
+  ///////////////////////// TraceWriter::event //////////////////////////////
+  void TraceWriter::event(const char *fmt, ...)
+  {
+    char buffer[1024];
+
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buffer, sizeof(buffer), fmt, args);
+    va_end(args);
+
+    if (!m_first)
+      m_fout << ",\n";
+
+    m_fout << buffer;
+
+    m_first = false;
+  }
+
+
+  ///////////////////////// TraceWriter::thread /////////////////////////////
+  void TraceWriter::thread(int tid, const char *name)
+  {
+    if (!(m_seen & (1ull << tid)))
+    {
+      event("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s %d\"}}", tid, name, tid);
+
+      m_seen |= (1ull << tid);
+    }
+  }
+
+
+  ///////////////////////// TraceWriter::info ///////////////////////////////
+  void TraceWriter::info(DebugLogInfoChunk const &info)
+  {
+    m_names[info.id] = escape(info.name);
+  }
+
+
+  ///////////////////////// TraceWriter::entry //////////////////////////////
+  void TraceWriter::entry(DebugLogEntry const &entry)
+  {
+    int tid = entry.thread;
+
+    thread(tid, "Thread");
+
+    switch(entry.type)
+    {
+      case DebugLogEntry::FrameMarker:
+        event("{\"name\":\"Frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}", tid, micros(entry.timestamp));
+        break;
+
+      case DebugLogEntry::EnterBlock:
+        event("{\"name\":\"%s\",\"ph\":\"B\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}", m_names[entry.info].c_str(), tid, micros(entry.timestamp));
+        break;
+
+      case DebugLogEntry::ExitBlock:
+        event("{\"ph\":\"E\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}", tid, micros(entry.timestamp));
+        break;
+
+      case DebugLogEntry::GpuSubmit:
+        m_gpubase[tid] = entry.timestamp;
+        break;
+
+      case DebugLogEntry::GpuBlock:
+        event("{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", m_names[entry.info].c_str(), GpuTrack, micros(m_gpubase[tid]), entry.duration / 1000.0);
+        m_gpubase[tid] += (unsigned long long)(entry.duration * 0.000000001 * m_clockfrequency);
+        break;
+
+      case DebugLogEntry::RenderLump:
+      case DebugLogEntry::RenderStorage:
+      case DebugLogEntry::ResourceSlot:
+      case DebugLogEntry::ResourceBuffer:
+      case DebugLogEntry::EntitySlot:
+        event("{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"used\":%u,\"capacity\":%u}}", resource_name(entry.type), micros(entry.timestamp), entry.resourceused, entry.resourcecapacity);
+        break;
+
+      case DebugLogEntry::HitCount:
+        event("{\"name\":\"Hit Count\",\"ph\":\"C\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"args\":{\"hits\":%llu}}", tid, micros(entry.timestamp), (unsigned long long)entry.hitcount);
+        break;
+    }
+  }
+
+
+  ///////////////////////// TraceWriter::arena //////////////////////////////
+  void TraceWriter::arena(DebugLogArenaChunk const &arena)
+  {
+    char tag[sizeof(arena.tag) + 1] = {};
+    memcpy(tag, arena.tag, sizeof(arena.tag));
+
+    event("{\"name\":\"Arena %s\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"size\":%llu,\"highwater\":%llu,\"free\":%llu}}", escape(tag).c_str(), micros(arena.timestamp), (unsigned long long)arena.size, (unsigned long long)arena.highwater, (unsigned long long)arena.freebytes);
+  }
+}
+
+
+///////////////////////// write_chrome_trace ////////////////////////////////
+void write_chrome_trace(istream &fin, ostream &fout)
+{
+  DebugLogHeader header;
+
+  fin.read((char*)&header, sizeof(header));
+
+  if (!fin || header.magic != 0x44544d44)
+    throw runtime_error("Invalid File Header");
+
+  if (header.version != 2)
+    throw runtime_error("Unsupported File Version");
+
+  TraceWriter writer(fout, header.clockfrequency);
+
+  DebugLogChunk chunk;
+
+  while (fin.read((char*)&chunk, sizeof(chunk)))
+  {
+    switch(chunk.type)
+    {
+      case 1:
+        {
+          DebugLogInfoChunk info;
+          fin.read((char*)&info, sizeof(info));
+
+          info.name[sizeof(info.name)-1] = 0;
+
+          writer.info(info);
+        }
+        break;
+
+      case 2:
+        {
+          uint32_t entrycount;
+          fin.read((char*)&entrycount, sizeof(entrycount));
+
+          for(uint32_t i = 0; i < entrycount && fin; ++i)
+          {
+            DebugLogEntry entry;
+            fin.read((char*)&entry, sizeof(entry));
+
+            writer.entry(entry);
+          }
+        }
+        break;
+
+      case 3:
+        {
+          DebugLogArenaChunk arena;
+          fin.read((char*)&arena, sizeof(arena));
+
+          writer.arena(arena);
+        }
+        break;
+
+      default:
+        fin.ignore(chunk.length);
+    }
+  }
+}
@@ -0,0 +1,17 @@
+//
+// Datum - trace writer
+//
+
+//
+// Copyright (c) 2017 Peter Niekamp
+//
+
+#pragma once
+
+#include <iostream>
+
+//
+// Trace Writers
+//
+
+void write_chrome_trace(std::istream &fin, std::ostream &fout);